@@ -1292,6 +1292,16 @@ VertexArray::~VertexArray() {
 // END vertex_array.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start instanced_render_context.cpp
+//------------------------------------------------------------------------------
+
+void (*givr::instanceUploadHook)(std::size_t instances, std::size_t bytes) = nullptr;
+
+//------------------------------------------------------------------------------
+// END instanced_render_context.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start buffer.cpp
 //------------------------------------------------------------------------------
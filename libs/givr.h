@@ -16644,6 +16644,10 @@ template <typename GeometryT, typename StyleT> struct InstancedRenderContext {
   std::vector<mat4f> modelTransforms;
   std::unique_ptr<Buffer> modelTransformsBuffer;
 
+  // Non-owning view of transforms owned by the caller (see setInstances).
+  // When set it is drawn instead of modelTransforms and reset after the draw.
+  gsl::span<const mat4f> instanceView;
+
   // Keep references to the GL_ARRAY_BUFFERS so that
   // the stay in scope for this context.
   std::vector<std::unique_ptr<Buffer>> arrayBuffers;
@@ -16669,6 +16673,10 @@ template <typename GeometryT, typename StyleT> struct InstancedRenderContext {
   std::string getModelSource() { return "layout(location=0) in "; }
 };
 
+// Called by drawInstanced with the number of instances and bytes it uploads,
+// lets the application count uploads without givr depending on it.
+extern void (*instanceUploadHook)(std::size_t instances, std::size_t bytes);
+
 template <typename GeometryT, typename StyleT, typename ViewContextT>
 void drawInstanced(
     InstancedRenderContext<GeometryT, StyleT> &ctx, ViewContextT const &viewCtx,
@@ -16687,26 +16695,35 @@ void drawInstanced(
   ctx.vao->bind();
   glPolygonMode(GL_FRONT, GL_FILL);
   GLenum mode = givr::getMode(ctx.primitive);
+
+  // Upload straight from the caller's view if there is one.
+  gsl::span<const mat4f> instances =
+      ctx.instanceView.size() > 0 ? ctx.instanceView
+                                  : gsl::span<const mat4f>(ctx.modelTransforms);
+  GLsizei instanceCount = GLsizei(instances.size());
   ctx.modelTransformsBuffer->bind(GL_ARRAY_BUFFER);
-  ctx.modelTransformsBuffer->data(
-      GL_ARRAY_BUFFER, gsl::span<mat4f>(ctx.modelTransforms), GL_DYNAMIC_DRAW);
+  ctx.modelTransformsBuffer->data(GL_ARRAY_BUFFER, instances, GL_DYNAMIC_DRAW);
+  if (instanceUploadHook) {
+    instanceUploadHook(instances.size(), instances.size() * sizeof(mat4f));
+  }
 
   if constexpr (hasIndices<GeometryT>::value) {
     if (ctx.numberOfIndices > 0) {
       glDrawElementsInstanced(mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0,
-                              ctx.modelTransforms.size());
+                              instanceCount);
     } else {
       glDrawArraysInstanced(mode, ctx.startIndex, ctx.vertexCount,
-                            ctx.modelTransforms.size());
+                            instanceCount);
     }
   } else {
     glDrawArraysInstanced(mode, ctx.startIndex, ctx.vertexCount,
-                          ctx.modelTransforms.size());
+                          instanceCount);
   }
 
   ctx.vao->unbind();
 
   ctx.modelTransforms.clear();
+  ctx.instanceView = gsl::span<const mat4f>();
 }
 
 template <typename GeometryT, typename StyleT>
@@ -16987,6 +17004,21 @@ void addInstance(InstancedRenderContext<GeometryT, StyleT> &ctx,
                  glm::mat4 const &f) {
   ctx.modelTransforms.push_back(f);
 }
+// Appends a whole array of transforms in one copy.
+template <typename GeometryT, typename StyleT>
+void addInstances(InstancedRenderContext<GeometryT, StyleT> &ctx,
+                  gsl::span<const mat4f> transforms) {
+  ctx.modelTransforms.insert(ctx.modelTransforms.end(), transforms.begin(),
+                             transforms.end());
+}
+// Draws the next frame straight from transforms owned by the caller, without
+// copying them. The view replaces any added instances, is only read by the next
+// draw call and must stay valid until then.
+template <typename GeometryT, typename StyleT>
+void setInstances(InstancedRenderContext<GeometryT, StyleT> &ctx,
+                  gsl::span<const mat4f> transforms) {
+  ctx.instanceView = transforms;
+}
 
 } // namespace givr
 //------------------------------------------------------------------------------
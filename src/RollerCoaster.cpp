@@ -8,7 +8,13 @@
  */
 
 #include "RollerCoaster.hpp"
+#include "transform_batch.hpp"
+#include "profiler.hpp"
+#include "poisson_disk.hpp"
+#include "spatial_hash.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 namespace modelling
@@ -31,62 +37,120 @@ namespace modelling
 
     }
 
-    void RollerCoaster::UpdateCurve(HermiteCurve new_curve)
+    RollerCoaster RollerCoaster::StagingCopy() const
+    {
+        RollerCoaster staging(s_dist, min_v, decel_frac, delta_s, delta_h, support_spacing, num_trees);
+        staging.scheduler = scheduler;
+        staging.tree_seed = tree_seed;
+        staging.adaptive_spacing = adaptive_spacing;
+        staging.max_visual_error = max_visual_error;
+        staging.gravity = gravity;
+        staging.tree_transforms = tree_transforms;
+        staging.bvh = bvh;
+        return staging;
+    }
+
+    void RollerCoaster::UpdateCurve(CoasterCurve new_curve)
     {
         // set the new curve
-        curve = new_curve;
+        curve = std::move(new_curve);
 
-        // we want the delta u value to result in smaller distance jumps than delta_s
-        // first calculate the maximum change in distance vs change in u max(dS/du)
-        // this is calculated as max_seperation * number_points
-        // then we require that delta_u * dS/du < delta_s or delta_u < du/dS * delta_s
-        delta_u = (SAMPLING_FACTOR * delta_s) / (float(curve.size()) * curve.maxSeperation());
-        table = calculateArcLengthTable(curve, delta_s, delta_u);
-       
+        // we only want to re-generate the trees after a new track is loaded
+        Rebuild(true, true, true);
+    }
 
-        // calculate the velocity value at the u value just before the decceleration point
-        // first get the hight
-        s_start_dec = table.arc_length * decel_frac;
-        float z = curve(table(s_start_dec)).y;
-        // get the max height
-        H = table.max_height;
-        s_freefall = table.s_max_height;
-        // calculate the velocity at this point using the conservation of energy
-        float v_dec = std::sqrt(19.62 * (H - z) + min_v * min_v);
-        // bound with min_v
-        v_start_dec = std::max(v_dec, min_v);
+    void RollerCoaster::SetCurve(CoasterCurve new_curve)
+    {
+        // set the new curve
+        curve = std::move(new_curve);
+        Rebuild(true, false, false);
+    }
 
-        // track must be setup after the velocity parameters are found
-        track.setupTrack(this, s_dist, delta_h);
-        GenerateSupports();
+    CoasterCurve const &RollerCoaster::GetCurve() const
+    {
+        return curve;
+    }
 
-        // we only want to re-generate the trees after a new track is loaded
-        GenerateTrees();
+    void RollerCoaster::RebuildTrack()
+    {
+        Rebuild(false, true, false);
+    }
 
-        //printf("curve updated, H: %10.2f, v_start_dec: %10.2f\n", H, v_start_dec);
+    void RollerCoaster::GenerateTrees()
+    {
+        Rebuild(false, false, true);
+    }
+
+    void RollerCoaster::SetAdaptiveSpacing(bool adaptive, float max_error)
+    {
+        adaptive_spacing = adaptive;
+        max_visual_error = max_error;
+    }
+
+    bool RollerCoaster::AdaptiveSpacing() const
+    {
+        return adaptive_spacing;
+    }
+
+    float RollerCoaster::MaxVisualError() const
+    {
+        return max_visual_error;
+    }
+
+    void RollerCoaster::PlaceAdaptively(float min_spacing, float max_spacing, float half_width, float max_error, std::pmr::vector<float> &positions) const
+    {
+        positions.clear();
+        positions.push_back(0.0f);
+        float length = frames.length();
+        if (length <= 0.0f || min_spacing <= 0.0f)
+        {
+            return;
+        }
+
+        float last = 0.0f;   // the s of the last piece
+        float turned = 0.0f; // the angle the frame turned from the last piece up to s_prev
+        float s_prev = 0.0f;
+        glm::quat q_prev = frames.orientation(0.0f);
+        size_t steps = size_t(length / min_spacing);
+        for (size_t i = 1; i < steps; i++)
+        {
+            float s = float(i) * min_spacing;
+            glm::quat q = frames.orientation(s);
+            // the angle the frame turns over this step (just the tangent for a piece with no width)
+            float step = half_width > 0.0f
+                ? 2.0f * std::acos(std::min(std::abs(glm::dot(q_prev, q)), 1.0f))
+                : std::acos(glm::clamp(glm::dot(q_prev * glm::vec3(0.0f, 0.0f, 1.0f), q * glm::vec3(0.0f, 0.0f, 1.0f)), -1.0f, 1.0f));
+
+            // put a piece at the previous step if reaching this one would break the bound
+            float l = s - last;
+            float error = (turned + step) * (l / 8.0f + half_width / 2.0f);
+            if ((l > max_spacing || error > max_error) && s_prev > last)
+            {
+                positions.push_back(s_prev);
+                last = s_prev;
+                turned = 0.0f;
+            }
+            turned += step;
+            q_prev = q;
+            s_prev = s;
+        }
+    }
+
+    void RollerCoaster::SetTreeSeed(uint32_t seed)
+    {
+        tree_seed = seed;
+    }
+
+    uint32_t RollerCoaster::TreeSeed() const
+    {
+        return tree_seed;
     }
 
     void RollerCoaster::UpdateArcLengthTable(float _delta_s)
     {
-        // re-calculate delta u value
+        // re-calculate the table and update track and other objects
         delta_s = _delta_s;
-        delta_u = (SAMPLING_FACTOR * delta_s) / (float(curve.size()) * curve.maxSeperation());
-        table = calculateArcLengthTable(curve, delta_s, delta_u);
-        // calculate the velocity value at the u value just before the decceleration point
-        // first get the hight
-        s_start_dec = table.arc_length * decel_frac;
-        float z = curve(table(s_start_dec)).y;
-        // get the max height
-        H = table.max_height;
-        s_freefall = table.s_max_height;
-        // calculate the velocity at this point using the conservation of energy
-        float v_dec = std::sqrt(19.62 * (H - z) + min_v * min_v);
-        // bound with min_v
-        v_start_dec = std::max(v_dec, min_v);
-
-        // update track and other objects
-        track.setupTrack(this, s_dist, delta_h);
-        GenerateSupports();
+        Rebuild(true, true, false);
     }
 
     void RollerCoaster::UpdateTrack(float _s_dist, float _min_v, float _decel_frac, float h)
@@ -96,170 +160,355 @@ namespace modelling
         decel_frac = _decel_frac;
         delta_h = h;
 
-        // calculate the velocity value at the u value just before the decceleration point
-        // first get the hight
-        s_start_dec = table.arc_length * decel_frac;
-        float z = curve(table(s_start_dec)).y;
-        // get the max height
-        H = table.max_height;
-        s_freefall = table.s_max_height;
-        // calculate the velocity at this point using the conservation of energy
-        float v_dec = std::sqrt(19.62 * (H - z) + min_v * min_v);
-        // bound with min_v
-        v_start_dec = std::max(v_dec, min_v);
-
-        track.setupTrack(this, s_dist, delta_h);
-        GenerateSupports();
+        Rebuild(false, true, false);
     }
 
-    glm::mat4 RollerCoaster::GetTransformAtPosition(float s) const
+    void RollerCoaster::SetScheduler(tasks::TaskScheduler *_scheduler)
     {
-        // get the positions at this s value
-        glm::vec3 p = curve(table(s));
-        glm::vec3 p_nh = curve(table(s - delta_h));
-        glm::vec3 p_h = curve(table(s + delta_h));
-
-        // the vectors forming the triangle
-        glm::vec3 a = p - p_nh;
-        glm::vec3 b = p_h - p;
-        glm::vec3 c = p_h - p_nh;
+        scheduler = _scheduler;
+    }
 
-        // the tangents
-        glm::vec3 T = glm::normalize(c);
-        glm::vec3 t0 = glm::normalize(a);
-        glm::vec3 t1 = glm::normalize(b);
+    void RollerCoaster::ParallelFor(size_t n, size_t grain, std::function<void(size_t, size_t)> const &fn) const
+    {
+        if (scheduler)
+        {
+            scheduler->parallel_for(0, n, grain, fn);
+        }
+        else
+        {
+            fn(0, n);
+        }
+    }
 
-        // the normal vector
-        glm::vec3 n_raw = glm::normalize(b - a);
-        n_raw = glm::normalize(n_raw - (glm::dot(n_raw, T)*T));
+    void RollerCoaster::Rebuild(bool build_table, bool build_track, bool build_trees)
+    {
+        using TaskHandle = tasks::TaskScheduler::TaskHandle;
+        // the rebuild's tasks count into this block whichever thread runs them
+        metrics::Sink rebuild_sink;
+        metrics::ScopedSink metrics_scope(rebuild_sink);
+
+        // submits a node of the rebuild graph, without a scheduler the nodes just run in the order they are given
+        auto node = [this](const char *name, std::function<void()> fn, std::initializer_list<TaskHandle> dependencies) {
+            if (scheduler)
+            {
+                return scheduler->submit(name, std::move(fn), dependencies);
+            }
+            fn();
+            return TaskHandle();
+        };
 
-        // the curvature
-        float k = 2.0f * glm::length(glm::cross(t0,t1)) / glm::length(c);
+        TaskHandle table_task, bvh_task;
+        if (build_table)
+        {
+            table_task = node("arc length table", [this]() {
+                PROFILE_SCOPE("arc length table");
+                delta_u = TableDeltaU();
+                table = calculateArcLengthTable(curve, delta_s, delta_u);
+            }, {});
+            // the segment tree only depends on the control points
+            bvh_task = node("curve bvh", [this]() {
+                PROFILE_SCOPE("curve bvh");
+                bvh = CurveBVH(curve);
+            }, {});
+        }
 
-        /*
-        if(glm::length(a) > 2.0 * glm::length(b))
+        // the speed parameters depend on the table and the motion parameters, so they are always refreshed
+        TaskHandle speed_task;
+        if (build_table || build_track)
         {
-            printf("length b is too small at position s: %10.3f, u: %10.7f, length a: %10.7f, length b: %10.7f\n", s, table(s), glm::length(a), glm::length(b));
+            speed_task = node("speed parameters", [this]() { UpdateSpeedParameters(); }, {table_task});
         }
 
-        if (2.0 * glm::length(a) < glm::length(b))
+        // frames first, the track pieces and supports are placed using them
+        TaskHandle frames_task, track_task, supports_task, trees_task;
+        if (build_track)
         {
-            printf("length a is too small at position s: %10.3f, u: %10.7f, length a: %10.7f, length b: %10.7f\n", s, table(s), glm::length(a), glm::length(b));
+            frames_task = node("frames", [this]() { GenerateFrames(); }, {speed_task});
+            track_task = node("track pieces", [this]() { track.setupTrack(this, s_dist, delta_h); }, {frames_task});
+            supports_task = node("supports", [this]() { GenerateSupports(); }, {frames_task});
         }
-        */
-        //printf("radius: %10.4f, length a: %10.4f, length b: %10.4f, length c: %10.4f\n", (1.0f / k), glm::length(a), glm::length(b), glm::length(c));
-
-        // the acceleration at this point
-        float v = GetSpeedAtPos(s);
-        glm::vec3 acc = n_raw * k * v * v;
-
-        // gravity tangent
-        glm::vec3 g_tan = gravity - glm::dot(gravity, T)*T;
-
-        // total acceleration vector
-        glm::vec3 N = glm::normalize((acc -g_tan));
-
-        // bi-normal
-        glm::vec3 B = glm::cross(N, T);
-
-        glm::mat4 M = glm::mat4{1.0f};
-        
-        M[0][0] = B.x;
-        M[0][1] = B.y;
-        M[0][2] = B.z;
-
-        M[1][0] = N.x;
-        M[1][1] = N.y;
-        M[1][2] = N.z;
-        
-        M[2][0] = T.x;
-        M[2][1] = T.y;
-        M[2][2] = T.z;
-        
-        M[3][0] = p.x;
-        M[3][1] = p.y;
-        M[3][2] = p.z;
-
-        // used for testing
-        /*
-        float last_tan_dv = glm::length(last_tan - T);
-        if(last_tan_dv > 0.1f)
+        if (build_trees)
         {
-            printf("last_tan_dv: %10.5f, at position s: %10.3f, at u: %10.7f\n", last_tan_dv, s, table(s));
+            trees_task = node("trees", [this]() { BuildTrees(); }, {speed_task, frames_task});
         }
-        last_tan = T;
-        */
 
-        // create the transform matrix
-        M = glm::scale(M, glm::vec3{0.75});
-        //PrintMat4(M);
-        // store the transform matrix
-        return M;
+        if (scheduler)
+        {
+            scheduler->wait(table_task);
+            scheduler->wait(bvh_task);
+            scheduler->wait(speed_task);
+            scheduler->wait(track_task);
+            scheduler->wait(supports_task);
+            scheduler->wait(trees_task);
+        }
+
+        rebuild_metrics = rebuild_sink.snapshot();
     }
 
-    glm::mat4 RollerCoaster::GetLevelTransformAtPosition(float s) const
+    float RollerCoaster::TableDeltaU() const
     {
-        // get the positions at this s value
-        glm::vec3 p = curve(table(s));
-        glm::vec3 p_nh = curve(table(s - delta_h));
-        glm::vec3 p_h = curve(table(s + delta_h));
+        // we want the delta u value to result in smaller distance jumps than delta_s
+        // first calculate the maximum change in distance vs change in u max(dS/du)
+        // this is calculated as max_seperation * number_points
+        // then we require that delta_u * dS/du < delta_s or delta_u < du/dS * delta_s
+        return (SAMPLING_FACTOR * delta_s) / (float(curve.size()) * curve.maxSeperation());
+    }
 
-        // the vectors forming the triangle
-        glm::vec3 c = p_h - p_nh;
+    void RollerCoaster::BeginSlicedRebuild(CoasterCurve new_curve)
+    {
+        curve = std::move(new_curve);
+        delta_u = TableDeltaU();
+        table_builder = ArcLengthTableBuilder(curve, delta_s, delta_u);
+        slice_stage = SliceStage::Table;
+        slice_index = 0;
+        slice_count = 0;
+        rebuild_metrics = metrics::Snapshot();
+    }
 
-        // the tangents
-        glm::vec3 T = glm::normalize(c);
+    bool RollerCoaster::StepSlicedRebuild(std::chrono::steady_clock::time_point deadline)
+    {
+        PROFILE_SCOPE("sliced rebuild");
+        // counted apart from the frame it runs in
+        metrics::Sink step_sink;
+        metrics::ScopedSink metrics_scope(step_sink);
+
+        // runs fn over the rest of the current stage in slices, returns true when the stage is finished
+        auto slices = [&](auto fn) {
+            while (slice_index < slice_count)
+            {
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    return false;
+                }
+                size_t end = std::min(slice_index + REBUILD_SLICE, slice_count);
+                fn(slice_index, end);
+                slice_index = end;
+            }
+            return true;
+        };
+        // moves on to the next stage with count items
+        auto next = [&](SliceStage stage, size_t count) {
+            slice_stage = stage;
+            slice_index = 0;
+            slice_count = count;
+        };
+
+        // run the stages in order until the deadline, each one sets up the next when it is done
+        while (slice_stage != SliceStage::Idle && std::chrono::steady_clock::now() < deadline)
+        {
+            switch (slice_stage)
+            {
+            case SliceStage::Idle:
+                break;
+            case SliceStage::Table:
+                if (!table_builder.advance(curve, REBUILD_SLICE))
+                {
+                    break;
+                }
+                table = table_builder.take();
+                UpdateSpeedParameters();
+                BeginFrames(frame_build);
+                next(SliceStage::FramePoints, frame_build.points.size());
+                break;
+            case SliceStage::FramePoints:
+                if (slices([&](size_t begin, size_t end) {
+                        ParallelFor(end - begin, PARALLEL_GRAIN, [&](size_t b, size_t e) { FramePoints(frame_build, begin + b, begin + e); });
+                    }))
+                {
+                    next(SliceStage::FrameTangents, slice_count);
+                }
+                break;
+            case SliceStage::FrameTangents:
+                if (slices([&](size_t begin, size_t end) {
+                        ParallelFor(end - begin, PARALLEL_GRAIN, [&](size_t b, size_t e) { FrameTangents(frame_build, begin + b, begin + e); });
+                    }))
+                {
+                    next(SliceStage::FrameRotations, slice_count);
+                }
+                break;
+            case SliceStage::FrameRotations:
+                // each slice carries on from the normal the last one ended with
+                if (slices([&](size_t begin, size_t end) { FrameRotations(frame_build, begin, end); }))
+                {
+                    next(SliceStage::FrameTwist, slice_count);
+                }
+                break;
+            case SliceStage::FrameTwist:
+                if (slices([&](size_t begin, size_t end) {
+                        ParallelFor(end - begin, PARALLEL_GRAIN, [&](size_t b, size_t e) { FrameTwist(frame_build, begin + b, begin + e); });
+                    }))
+                {
+                    next(SliceStage::FrameBanks, slice_count);
+                }
+                break;
+            case SliceStage::FrameBanks:
+                if (slices([&](size_t begin, size_t end) { FrameBanks(frame_build, begin, end); }))
+                {
+                    next(SliceStage::TrackPieces, track.beginTrack(this, s_dist));
+                }
+                break;
+            case SliceStage::TrackPieces:
+                if (slices([&](size_t begin, size_t end) {
+                        ParallelFor(end - begin, PARALLEL_GRAIN, [&](size_t b, size_t e) { track.buildPieces(this, begin + b, begin + e); });
+                    }))
+                {
+                    next(SliceStage::Supports, BeginSupports());
+                }
+                break;
+            case SliceStage::Supports:
+                if (slices([&](size_t begin, size_t end) {
+                        ParallelFor(end - begin, PARALLEL_GRAIN, [&](size_t b, size_t e) { BuildSupports(begin + b, begin + e); });
+                    }))
+                {
+                    // a drag keeps the number of control points, so the tree only needs new boxes
+                    if (bvh.size() == curve.size())
+                    {
+                        next(SliceStage::TreeSegments, curve.size());
+                    }
+                    else
+                    {
+                        bvh = CurveBVH(curve);
+                        next(SliceStage::TreeNodes, 0);
+                    }
+                }
+                break;
+            case SliceStage::TreeSegments:
+                if (slices([&](size_t begin, size_t end) { bvh.refitSegments(curve, begin, end); }))
+                {
+                    next(SliceStage::TreeNodes, bvh.nodeCount());
+                }
+                break;
+            case SliceStage::TreeNodes:
+                // empty after a full build, the new tree already has its boxes
+                if (slices([&](size_t begin, size_t end) { bvh.refitNodes(begin, end); }))
+                {
+                    // let go of the scratch arrays (back to the rebuild pool)
+                    frame_build = FrameBuild();
+                    next(SliceStage::Idle, 0);
+                }
+                break;
+            }
+        }
+
+        rebuild_metrics += step_sink.snapshot();
+        return slice_stage == SliceStage::Idle;
+    }
 
-        // normal vector alligned with gravity
-        glm::vec3 N = glm::normalize((-gravity));
+    float RollerCoaster::SlicedRebuildProgress() const
+    {
+        // the table is roughly half of the work, the other stages share the rest
+        constexpr float STAGES = float(SliceStage::TreeNodes) - float(SliceStage::Table);
+        if (slice_stage == SliceStage::Idle)
+        {
+            return 1.0f;
+        }
+        if (slice_stage == SliceStage::Table)
+        {
+            return 0.5f * table_builder.progress();
+        }
+        float stage = float(slice_stage) - float(SliceStage::Table) - 1.0f;
+        float within = slice_count > 0 ? float(slice_index) / float(slice_count) : 0.0f;
+        return 0.5f + 0.5f * (stage + within) / STAGES;
+    }
 
-        // gravity tangent
-        T = glm::normalize(T - glm::dot(T, N) * N);
+    metrics::Snapshot RollerCoaster::LastRebuildMetrics() const
+    {
+        return rebuild_metrics;
+    }
 
-        // bi-normal
-        glm::vec3 B = glm::cross(N, T);
+    void RollerCoaster::UpdateSpeedParameters()
+    {
+        // calculate the velocity value at the u value just before the decceleration point
+        // first get the hight
+        s_start_dec = table.arc_length * decel_frac;
+        float z = curve(table(s_start_dec)).y;
+        // get the max height
+        H = table.max_height;
+        s_freefall = table.s_max_height;
+        // calculate the velocity at this point using the conservation of energy
+        float v_dec = std::sqrt(19.62 * (H - z) + min_v * min_v);
+        // bound with min_v
+        v_start_dec = std::max(v_dec, min_v);
+    }
 
-        glm::mat4 M = glm::mat4{1.0f};
+    glm::mat4 RollerCoaster::GetTransformAtPosition(float s) const
+    {
+        // the cached position and banked rotation minimizing frame
+        FrameCache::Frame f = frames(s);
+        glm::vec3 T = f.orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+        glm::vec3 N = f.orientation * glm::vec3(0.0f, 1.0f, 0.0f);
 
-        M[0][0] = B.x;
-        M[0][1] = B.y;
-        M[0][2] = B.z;
+        // create the transform matrix
+        glm::mat4 M;
+        assembleTransforms(1, &f.position, &T, &N, glm::vec3(TRACK_SCALE), &M);
+        return M;
+    }
 
-        M[1][0] = N.x;
-        M[1][1] = N.y;
-        M[1][2] = N.z;
+    glm::mat4 RollerCoaster::GetLevelTransformAtPosition(float s) const
+    {
+        // the cached position and frame at this s value
+        FrameCache::Frame f = frames(s);
+        glm::vec3 T = LevelTangent(f);
 
-        M[2][0] = T.x;
-        M[2][1] = T.y;
-        M[2][2] = T.z;
+        // normal vector alligned with gravity, the tangent is levelled against it
+        glm::vec3 N = -gravity;
 
-        M[3][0] = p.x;
-        M[3][1] = p.y;
-        M[3][2] = p.z;
-        //  store the transform matrix
+        glm::mat4 M;
+        assembleTransforms(1, &f.position, &T, &N, glm::vec3(1.0f), &M);
         return M;
     }
 
+    FrameCache::Frame RollerCoaster::GetFrameAtPosition(float s) const
+    {
+        return frames(s);
+    }
+
+    FrameCache const &RollerCoaster::GetFrameCache() const
+    {
+        return frames;
+    }
+
+    glm::vec3 RollerCoaster::LevelTangent(FrameCache::Frame const &f) const
+    {
+        glm::vec3 T = f.orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+
+        // the track normal is level when the track goes straight up or down
+        glm::vec3 up = glm::normalize(-gravity);
+        if (glm::length(glm::cross(up, T)) < 1e-4f)
+        {
+            T = f.orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        return T;
+    }
+
     glm::vec3 RollerCoaster::GetPositionAtS(float s) const
     {
-        glm::vec3 p = curve(table(s));
+        return frames.position(s);
+    }
 
-        return p;
+    CurvePoint RollerCoaster::ClosestPointOnTrack(glm::vec3 p) const
+    {
+        return bvh.closestPoint(p, table);
     }
 
-    std::vector<glm::mat4> *RollerCoaster::pieceTransforms()
+    CurveRayHit RollerCoaster::RaycastTrack(glm::vec3 origin, glm::vec3 direction, float radius) const
+    {
+        return bvh.raycast(origin, direction, radius, table);
+    }
+
+    std::pmr::vector<glm::mat4> *RollerCoaster::pieceTransforms()
     {
         return track.pieceTransforms();
     }
 
     // get the support transforms
-    std::vector<glm::mat4> *RollerCoaster::SupportTransforms()
+    std::pmr::vector<glm::mat4> *RollerCoaster::SupportTransforms()
     {
         return &support_transforms;
     }
 
     // get the tree transforms
-    std::vector<glm::mat4> *RollerCoaster::TreeTransforms()
+    std::pmr::vector<glm::mat4> *RollerCoaster::TreeTransforms()
     {
         return &tree_transforms;
     }
@@ -273,6 +522,11 @@ namespace modelling
             s = s + table.arc_length;
         }
 
+        return SpeedProfile(s, frames.position(s).y);
+    }
+
+    float RollerCoaster::SpeedProfile(float s, float z) const
+    {
         // deceleration region use decceleration function
         if(s > s_start_dec)
         {
@@ -285,7 +539,6 @@ namespace modelling
         }
 
         // use the conservation of energy or min speed everywhere else
-        float z = curve(table(s)).y;
         float v = std::sqrt(19.62 * (H - z) + min_v * min_v);
         return std::max(v, min_v);
     }
@@ -312,41 +565,235 @@ namespace modelling
     }
 
 
-    void RollerCoaster::GenerateTrees()
+    void RollerCoaster::GenerateFrames()
     {
-        tree_transforms = std::vector<glm::mat4>(num_trees);
+        PROFILE_SCOPE("GenerateFrames");
+
+        FrameBuild build;
+        BeginFrames(build);
+        size_t n = build.points.size();
+        ParallelFor(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) { FramePoints(build, begin, end); });
+        ParallelFor(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) { FrameTangents(build, begin, end); });
+        FrameRotations(build, 0, n);
+        ParallelFor(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) { FrameTwist(build, begin, end); });
+        FrameBanks(build, 0, n);
+    }
+
+    void RollerCoaster::BeginFrames(FrameBuild &build)
+    {
+        // one frame per arc length table entry, spaced so that the grid wraps exactly onto the start
+        size_t n = std::max(table.size(), size_t(1));
+        frames = FrameCache(table.arc_length, n);
+
+        build.points.resize(n);
+        build.tangents.resize(n);
+        build.curvatures.resize(n);
+        build.rmf.resize(n);
+
+        // the look ahead distance in whole grid steps
+        build.m = std::max(size_t(std::round(delta_h / frames.deltaS())), size_t(1));
+        build.m = std::min(build.m, std::max(n / 2, size_t(1)));
+    }
 
-        // loop through the distances to get the positions
-        for (size_t i = 0; i < num_trees; i++)
+    void RollerCoaster::FramePoints(FrameBuild &build, size_t begin, size_t end) const
+    {
+        // evaluate the curve once per grid point, everything else is found from these samples
+        constexpr size_t BATCH = 64;
+        float s[BATCH], U[BATCH];
+        float ds = frames.deltaS();
+        for (size_t batch = begin; batch < end; batch += BATCH)
+        {
+            size_t count = std::min(BATCH, end - batch);
+            for (size_t j = 0; j < count; j++)
+            {
+                s[j] = float(batch + j) * ds;
+            }
+            table(s, U, count);
+            for (size_t j = 0; j < count; j++)
+            {
+                build.points[batch + j] = curve(U[j]);
+            }
+        }
+    }
+
+    void RollerCoaster::FrameTangents(FrameBuild &build, size_t begin, size_t end) const
+    {
+        size_t n = build.points.size();
+        size_t m = build.m;
+        for (size_t i = begin; i < end; i++)
         {
-            // get some random positions
-            float rx = MAP_SIZE * ((float(std::rand() % 20000) / 10000.0f) - 1.0f);
-            float rz = MAP_SIZE * ((float(std::rand() % 20000) / 10000.0f) - 1.0f);
+            // get the positions around this grid point
+            const glm::vec3 &p = build.points[i];
+            const glm::vec3 &p_nh = build.points[(i + n - m) % n];
+            const glm::vec3 &p_h = build.points[(i + m) % n];
+
+            // the vectors forming the triangle
+            glm::vec3 a = p - p_nh;
+            glm::vec3 b = p_h - p;
+            glm::vec3 c = p_h - p_nh;
+
+            // the tangent (collapsed points only happen on a degenerate curve, fall back to z)
+            float len_c = glm::length(c);
+            glm::vec3 T = (len_c > 1e-6f) ? c / len_c : glm::vec3(0.0f, 0.0f, 1.0f);
+
+            // the curvature vector k * n, this is zero on straight track instead of normalizing a zero vector
+            glm::vec3 K = glm::vec3(0.0f);
+            if (glm::length(a) > 1e-6f && glm::length(b) > 1e-6f && len_c > 1e-6f)
+            {
+                K = 2.0f * (glm::normalize(b) - glm::normalize(a)) / len_c;
+                K = K - glm::dot(K, T) * T;
+            }
+
+            build.tangents[i] = T;
+            build.curvatures[i] = K;
+        }
+    }
 
-            // create the random transform position
-            tree_transforms[i] = glm::scale(glm::translate(glm::mat4{1.0f}, glm::vec3(rx, -BASE_LEVEL, rz)), glm::vec3(2.0f, 5.0f, 2.0f));
+    void RollerCoaster::FrameRotations(FrameBuild &build, size_t begin, size_t end) const
+    {
+        // the rotation minimizing frames, in order since each one follows from the last
+        if (begin == 0)
+        {
+            build.first_normal = firstFrameNormal(build.tangents[0], -gravity);
+            build.normal = build.first_normal;
+        }
+        propagateFrames(build.points, build.tangents, build.rmf, begin, end, build.normal);
+        if (end == build.points.size())
+        {
+            build.closing = closingTwist(build.normal, build.first_normal, build.tangents[0]);
+        }
+    }
+
+    void RollerCoaster::FrameTwist(FrameBuild &build, size_t begin, size_t end) const
+    {
+        distributeClosingTwist(build.rmf, build.closing, begin, end);
+    }
+
+    void RollerCoaster::FrameBanks(FrameBuild &build, size_t begin, size_t end)
+    {
+        // frames are appended in order so this part runs on one thread
+        float ds = frames.deltaS();
+        for (size_t i = begin; i < end; i++)
+        {
+            float s = float(i) * ds;
+            const glm::vec3 &T = build.tangents[i];
+
+            // the acceleration at this point
+            float v = SpeedProfile(s, build.points[i].y);
+            glm::vec3 acc = build.curvatures[i] * v * v;
+
+            // gravity tangent
+            glm::vec3 g_tan = gravity - glm::dot(gravity, T) * T;
+
+            // the normal follows the total acceleration, stored as a twist on top of the rotation minimizing frame
+            frames.addNext(build.points[i], build.rmf[i], bankAngle(build.rmf[i], acc - g_tan));
+        }
+    }
+
+    void RollerCoaster::BuildTrees()
+    {
+        PROFILE_SCOPE("BuildTrees");
+        tree_transforms.clear();
+        if (num_trees <= 0)
+        {
+            return;
+        }
+
+        // the track dropped onto the ground, sampled finely enough that a gap between samples cannot hide a tree
+        float length = ArcLength();
+        float spacing = 0.5f * TREE_CLEARANCE;
+        size_t n = length > 0.0f ? size_t(std::ceil(length / spacing)) : 0;
+        std::vector<glm::vec3> ground(n);
+        ParallelFor(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                glm::vec3 p = GetPositionAtS(float(i) * length / float(n));
+                ground[i] = glm::vec3(p.x, 0.0f, p.z);
+            }
+        });
+        SpatialHash hash(ground, TREE_CLEARANCE);
+
+        auto near_track = [&](glm::vec2 p) {
+            glm::vec3 q(p.x, 0.0f, p.y);
+            bool near = false;
+            hash.forEachNear(q, [&](uint32_t j) {
+                glm::vec3 d = ground[j] - q;
+                near = near || glm::dot(d, d) < TREE_CLEARANCE * TREE_CLEARANCE;
+            });
+            return near;
+        };
+
+        // a radius that gives a few more points than trees, the extras are thinned out below
+        float area = 4.0f * MAP_SIZE * MAP_SIZE;
+        float radius = TREE_SPACING_FACTOR * std::sqrt(area / float(num_trees));
+        std::vector<glm::vec2> points = poissonDiskSample(glm::vec2(-MAP_SIZE), glm::vec2(MAP_SIZE), radius, tree_seed, near_track, scheduler);
+
+        // a seeded partial shuffle picks which points keep a tree (the points are grouped by tile, so taking the first few would leave gaps)
+        std::mt19937 gen(tree_seed);
+        size_t count = std::min(points.size(), size_t(num_trees));
+        for (size_t i = 0; i < count; i++)
+        {
+            std::uniform_int_distribution<size_t> pick(i, points.size() - 1);
+            std::swap(points[i], points[pick(gen)]);
+        }
+
+        tree_transforms.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            glm::vec3 position(points[i].x, -BASE_LEVEL, points[i].y);
+            tree_transforms[i] = glm::scale(glm::translate(glm::mat4{1.0f}, position), glm::vec3(2.0f, 5.0f, 2.0f));
         }
     }
 
     void RollerCoaster::GenerateSupports()
     {
+        PROFILE_SCOPE("GenerateSupports");
+
+        // loop through the distances to get the positions, then store the transform matrices
+        ParallelFor(BeginSupports(), PARALLEL_GRAIN, [&](size_t begin, size_t end) { BuildSupports(begin, end); });
+    }
+
+    size_t RollerCoaster::BeginSupports()
+    {
+        // supports hold the track up, so only the centre line counts, against an error bound that grows with the
+        // spacing (the same bound as the track pieces would put a support at nearly every minimum gap)
+        if (adaptive_spacing)
+        {
+            float max_error = max_visual_error * support_spacing / s_dist;
+            PlaceAdaptively(ADAPTIVE_MIN_SPACING * support_spacing, ADAPTIVE_MAX_SPACING * support_spacing, 0.0f, max_error, support_s);
+            support_transforms.resize(support_s.size());
+            return support_s.size();
+        }
+
         // set the number of support pieces that will fit on the track
+        support_s.clear();
         size_t num_pieces = size_t(table.arc_length / support_spacing);
-        support_transforms = std::vector<glm::mat4>(num_pieces);
+        support_transforms.resize(num_pieces);
+        return num_pieces;
+    }
+
+    void RollerCoaster::BuildSupports(size_t begin, size_t end)
+    {
+        // scratch for one chunk, the transforms are assembled in batches of this size
+        constexpr size_t BATCH = 64;
+        glm::vec3 positions[BATCH], tangents[BATCH], normals[BATCH], scales[BATCH];
 
-        // loop through the distances to get the positions
-        float s = 0;
-        for (size_t i = 0; i < num_pieces; i++)
+        for (size_t batch = begin; batch < end; batch += BATCH)
         {
-            // store the transform matrix
-            glm::mat4 temp = GetLevelTransformAtPosition(s);
-            // scale based on the height at this position
-            float height = curve(table(s)).y + BASE_LEVEL;
-            float scale = height / SUPPORT_HEIGHT;
-            support_transforms[i] = glm::scale(temp, glm::vec3(1.0f, scale, 1.0f));
-
-            // increment the s value
-            s = s + support_spacing;
+            size_t count = std::min(BATCH, end - batch);
+            for (size_t j = 0; j < count; j++)
+            {
+                float s = support_s.empty() ? float(batch + j) * support_spacing : support_s[batch + j];
+                FrameCache::Frame f = frames(s);
+                positions[j] = f.position;
+                tangents[j] = LevelTangent(f);
+                normals[j] = -gravity;
+
+                // scale based on the height at this position
+                float height = f.position.y + BASE_LEVEL;
+                scales[j] = glm::vec3(1.0f, height / SUPPORT_HEIGHT, 1.0f);
+            }
+            assembleTransforms(count, positions, tangents, normals, scales, &support_transforms[batch]);
         }
     }
 }
\ No newline at end of file
@@ -11,7 +11,13 @@
 
 #include "hermite_curve.hpp"
 #include "arc_length_parameterize.hpp"
+#include "curve_bvh.hpp"
 #include "track.hpp"
+#include "frame_cache.hpp"
+#include "task_scheduler.hpp"
+#include "metrics.hpp"
+#include <chrono>
+#include <functional>
 #include <glm/glm.hpp>
 #include <vector>
 
@@ -19,11 +25,27 @@
 #define BASE_LEVEL 10.0f
 #define SUPPORT_HEIGHT 8.0f
 #define MAP_SIZE 100.0f
+#define TRACK_SCALE 0.75f
+#define PARALLEL_GRAIN 1024
+// the number of items (u steps, frames, pieces) a sliced rebuild does between checks of its deadline
+#define REBUILD_SLICE 4096
+// trees keep at least this far from the ground under the track
+#define TREE_CLEARANCE 4.0f
+// the tree spacing as a fraction of the spacing of a square grid of the same count (thinned back to the count)
+#define TREE_SPACING_FACTOR 0.6f
+#define TREE_SEED 587u
+// adaptive placement: the gaps between track pieces (or supports) stay within these multiples of the fixed spacing
+#define ADAPTIVE_MIN_SPACING 0.5f
+#define ADAPTIVE_MAX_SPACING 4.0f
+// the default largest visual error (world units) adaptive placement allows between two pieces
+#define ADAPTIVE_MAX_ERROR 0.05f
 
 namespace modelling
 {
     /**
      * Manages the curve, arclength table, track pieces, and cart movement
+     * The curve type is CoasterCurve, chosen at compile time (see hermite_curve.hpp), so the table walk and the
+     * frame sampling evaluate the curve inline with no dispatch.
      */
     class RollerCoaster
     {
@@ -46,11 +68,96 @@ namespace modelling
          */
         ~RollerCoaster();
 
+        // roller coasters are built on the loading thread and moved into place
+        RollerCoaster(RollerCoaster &&) = default;
+        RollerCoaster &operator=(RollerCoaster &&) = default;
+        RollerCoaster(const RollerCoaster &) = default;
+        RollerCoaster &operator=(const RollerCoaster &) = default;
+
+        /**
+         * a roller coaster to run a sliced rebuild on: the same settings, motion parameters, scheduler, trees and
+         * segment tree (so the rebuild only refits its boxes), but no curve, table, frames, track or supports
+         */
+        RollerCoaster StagingCopy() const;
+
         /**
          * updates to use the new given curve, also creates a new arc length table at updates the track
-         * @param new_curve the new curve to use
+         * @param new_curve the new curve to use (moved in, pass with std::move to avoid copying the control points)
+         */
+        void UpdateCurve(CoasterCurve new_curve);
+
+        /**
+         * the first half of UpdateCurve: sets the curve, builds the arc length table and the velocity parameters
+         * @param new_curve the new curve to use (moved in)
+         */
+        void SetCurve(CoasterCurve new_curve);
+
+        // the curve the track is built from
+        CoasterCurve const &GetCurve() const;
+
+        /**
+         * the second half of UpdateCurve: rebuilds the frames, track pieces and supports for the current table
+         */
+        void RebuildTrack();
+
+        /**
+         * switch between placing track pieces and supports at their fixed spacing and placing them adaptively
+         * (see PlaceAdaptively), call RebuildTrack after
+         * @param max_error the largest visual error allowed between two pieces
+         */
+        void SetAdaptiveSpacing(bool adaptive, float max_error = ADAPTIVE_MAX_ERROR);
+        bool AdaptiveSpacing() const;
+        float MaxVisualError() const;
+
+        /**
+         * Pick s positions along the track for pieces of half width half_width. The frame cache orientations are
+         * stepped through min_spacing apart, summing the angle the frame turns (curvature, torsion and banking
+         * together). Between two pieces the track bends by that angle theta, so the centre line strays about
+         * l theta / 8 from the straight run between them and the edges another half_width theta / 2; the next
+         * piece goes where that would pass max_error, or at max_spacing on a straight. With no width a twist around
+         * the tangent moves nothing, so only the turn of the tangent is summed.
+         * @param positions filled with the s positions, starting at 0
+         */
+        void PlaceAdaptively(float min_spacing, float max_spacing, float half_width, float max_error, std::pmr::vector<float> &positions) const;
+
+        // creates the array of tree transforms
+        void GenerateTrees();
+
+        // the seed of the tree layout, the same seed and track always give the same trees (call GenerateTrees after)
+        void SetTreeSeed(uint32_t seed);
+        uint32_t TreeSeed() const;
+
+        /**
+         * run the rebuilds on a task scheduler (table -> speed parameters -> frames -> track || supports || trees)
+         * @param _scheduler the scheduler to use, nullptr to rebuild serially on the calling thread
+         */
+        void SetScheduler(tasks::TaskScheduler *_scheduler);
+
+        /**
+         * start rebuilding the table, frames, track pieces, supports and segment tree for a new curve in slices
+         * (the trees are kept). Nothing is usable until StepSlicedRebuild returns true, so keep drawing another
+         * roller coaster in the meantime.
+         * @param new_curve the new curve to use (moved in)
          */
-        void UpdateCurve(HermiteCurve new_curve);
+        void BeginSlicedRebuild(CoasterCurve new_curve);
+
+        /**
+         * continue the sliced rebuild until the deadline (it is checked every REBUILD_SLICE items,
+         * only a segment tree for a different number of control points is built in one go)
+         * @return true once everything is rebuilt (also when there is nothing to do)
+         */
+        bool StepSlicedRebuild(std::chrono::steady_clock::time_point deadline);
+
+        // how far the sliced rebuild is in [0, 1]
+        float SlicedRebuildProgress() const;
+
+        // the hot path counters (curve evaluations, table lookups, transforms) of the last rebuild, only its own work
+        metrics::Snapshot LastRebuildMetrics() const;
+
+        /**
+         * call fn(begin, end) over chunks of [0, n), in parallel when there is a scheduler
+         */
+        void ParallelFor(size_t n, size_t grain, std::function<void(size_t, size_t)> const &fn) const;
 
         /**
          * updates the arc length table (and also the track because it depends on this)
@@ -78,17 +185,32 @@ namespace modelling
          */
         glm::mat4 GetLevelTransformAtPosition(float s) const;
 
+        // get the cached position and banked orientation at this s coordinate
+        FrameCache::Frame GetFrameAtPosition(float s) const;
+
+        // the cached frames along the track (cart transforms use TRACK_SCALE on top of these)
+        FrameCache const &GetFrameCache() const;
+
         // get the raw position at this s coordinate
         glm::vec3 GetPositionAtS(float s) const;
 
+        // the closest point on the curve to p (U, s and the distance to it)
+        CurvePoint ClosestPointOnTrack(glm::vec3 p) const;
+
+        /**
+         * find where a ray first comes within radius of the curve (for picking)
+         * @param direction the ray direction, does not have to be normalized
+         */
+        CurveRayHit RaycastTrack(glm::vec3 origin, glm::vec3 direction, float radius) const;
+
         // get a reference to the track piece transforms
-        std::vector<glm::mat4> *pieceTransforms();
+        std::pmr::vector<glm::mat4> *pieceTransforms();
 
         // get the support transforms
-        std::vector<glm::mat4> *SupportTransforms();
+        std::pmr::vector<glm::mat4> *SupportTransforms();
 
         // get the tree transforms
-        std::vector<glm::mat4> *TreeTransforms();
+        std::pmr::vector<glm::mat4> *TreeTransforms();
 
         /**
          * calculate the speed at an s position allong the track based on the movement parameters and conservation of energy
@@ -102,8 +224,10 @@ namespace modelling
          */
     private:
 
-        HermiteCurve curve;
+        CoasterCurve curve;
         ArcLengthTable table;
+        CurveBVH bvh;
+        FrameCache frames;
         Track track;
 
         // related to motion
@@ -120,23 +244,100 @@ namespace modelling
         float delta_s;
         float delta_h; // used for finding the normal to the curve
 
+        // runs the rebuilds (not owned), null to run them serially
+        tasks::TaskScheduler *scheduler = nullptr;
+
+        metrics::Snapshot rebuild_metrics;
+
+        // the scratch arrays for building the frame cache
+        struct FrameBuild
+        {
+            std::pmr::vector<glm::vec3> points{memory::rebuildResource()};
+            std::pmr::vector<glm::vec3> tangents{memory::rebuildResource()};
+            std::pmr::vector<glm::vec3> curvatures{memory::rebuildResource()};
+            std::pmr::vector<glm::quat> rmf{memory::rebuildResource()};
+            size_t m = 1; // the look ahead distance in grid steps
+            // the rotation minimizing frames resume from the last normal, the closing twist is found once it is back at the start
+            glm::vec3 first_normal = glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+            float closing = 0.0f;
+        };
+
+        // the state of a rebuild spread over several StepSlicedRebuild calls
+        enum class SliceStage
+        {
+            Idle,
+            Table,
+            FramePoints,
+            FrameTangents,
+            FrameRotations,
+            FrameTwist,
+            FrameBanks,
+            TrackPieces,
+            Supports,
+            TreeSegments,
+            TreeNodes,
+        };
+        SliceStage slice_stage = SliceStage::Idle;
+        size_t slice_index = 0; // the next item of the current stage
+        size_t slice_count = 0; // the number of items in the current stage
+        ArcLengthTableBuilder table_builder;
+        FrameBuild frame_build;
+
         // extra stuff
         float support_spacing;
         int num_trees;
+        uint32_t tree_seed = TREE_SEED;
+        bool adaptive_spacing = false;
+        float max_visual_error = ADAPTIVE_MAX_ERROR;
 
         // the array of transforms for each to the supports
-        std::vector<glm::mat4> support_transforms = std::vector<glm::mat4>(0);
+        std::pmr::vector<glm::mat4> support_transforms{memory::rebuildResource()};
+        // the s position of each support when they are placed adaptively (empty when they use support_spacing)
+        std::pmr::vector<float> support_s{memory::rebuildResource()};
         // the array of transforms for the trees
-        std::vector<glm::mat4> tree_transforms = std::vector<glm::mat4>(0);
+        std::pmr::vector<glm::mat4> tree_transforms{memory::rebuildResource()};
 
         // gravity
         glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
 
         void PrintMat4(glm::mat4 M) const;
 
-        // creates the array of tree transforms
-        void GenerateTrees();
+        // finds the deceleration point and maximum height used by the speed profile
+        void UpdateSpeedParameters();
+
+        /**
+         * rebuild the parts of the roller coaster that changed, as a task graph when there is a scheduler
+         * @param build_table rebuild the arc length table
+         * @param build_track rebuild the frames, track pieces and supports
+         * @param build_trees rebuild the trees
+         */
+        void Rebuild(bool build_table, bool build_track, bool build_trees);
+
+        // the tangent of a frame, or its normal when the tangent is vertical (used to level the supports)
+        glm::vec3 LevelTangent(FrameCache::Frame const &f) const;
+
+        // the speed at a (wrapped) s position with height z, used while the frame cache is being built
+        float SpeedProfile(float s, float z) const;
+
+        // creates the rotation minimizing frames and banking angles (needs the velocity parameters)
+        void GenerateFrames();
+        // the parts of GenerateFrames: size the cache, sample the curve, find tangents and curvature, frames, banking
+        void BeginFrames(FrameBuild &build);
+        void FramePoints(FrameBuild &build, size_t begin, size_t end) const;
+        void FrameTangents(FrameBuild &build, size_t begin, size_t end) const;
+        void FrameRotations(FrameBuild &build, size_t begin, size_t end) const;
+        void FrameTwist(FrameBuild &build, size_t begin, size_t end) const;
+        void FrameBanks(FrameBuild &build, size_t begin, size_t end);
+        // the delta u that keeps table steps shorter than delta_s
+        float TableDeltaU() const;
+        // scatters the trees with Poisson disk sampling, keeping them off the track (needs the frames)
+        void BuildTrees();
         // creates the array of support transforms
         void GenerateSupports();
+        // size the support array, returns the number of supports
+        size_t BeginSupports();
+        // place supports [begin, end)
+        void BuildSupports(size_t begin, size_t end);
     };
 }
\ No newline at end of file
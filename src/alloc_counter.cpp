@@ -0,0 +1,100 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<size_t> allocation_count{0};
+    std::atomic<size_t> allocated_bytes{0};
+    thread_local size_t thread_allocation_count = 0;
+
+    void *countedAlloc(size_t size) noexcept
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        thread_allocation_count++;
+        // malloc(0) may return null, always hand out a real pointer
+        return std::malloc(size > 0 ? size : 1);
+    }
+}
+
+namespace memory
+{
+    size_t heapAllocationCount()
+    {
+        return allocation_count.load(std::memory_order_relaxed);
+    }
+
+    size_t heapAllocatedBytes()
+    {
+        return allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    size_t threadHeapAllocationCount()
+    {
+        return thread_allocation_count;
+    }
+}
+
+// replace the global allocation functions so every new/delete in the program is counted
+void *operator new(size_t size)
+{
+    void *p = countedAlloc(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
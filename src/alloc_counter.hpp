@@ -0,0 +1,78 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace memory
+{
+    /**
+     * The number of calls to the global operator new since the program started (all threads).
+     * Take the difference between two calls to count the allocations made in between.
+     */
+    size_t heapAllocationCount();
+
+    /**
+     * The number of bytes requested from the global operator new since the program started (all threads).
+     */
+    size_t heapAllocatedBytes();
+
+    /**
+     * The number of calls to the global operator new made by the calling thread.
+     * Unlike heapAllocationCount this is not disturbed by other threads, use it to count the allocations of one job.
+     */
+    size_t threadHeapAllocationCount();
+
+    // the number of buffers of T allocated through CountingAllocator (all threads)
+    template <class T>
+    std::atomic<size_t> &bufferAllocations()
+    {
+        static std::atomic<size_t> count{0};
+        return count;
+    }
+
+    /**
+     * A std::allocator that counts every buffer it hands out in bufferAllocations<T>, so one kind of container can be
+     * counted exactly wherever it is allocated (the heap counters above also see every other allocation).
+     */
+    template <class T>
+    struct CountingAllocator : std::allocator<T>
+    {
+        using value_type = T;
+        template <class U>
+        struct rebind
+        {
+            using other = CountingAllocator<U>;
+        };
+
+        CountingAllocator() = default;
+        template <class U>
+        CountingAllocator(CountingAllocator<U> const &) noexcept
+        {
+        }
+
+        T *allocate(size_t n)
+        {
+            bufferAllocations<T>().fetch_add(1, std::memory_order_relaxed);
+            return std::allocator<T>::allocate(n);
+        }
+    };
+
+    template <class T, class U>
+    bool operator==(CountingAllocator<T> const &, CountingAllocator<U> const &)
+    {
+        return true;
+    }
+
+    template <class T, class U>
+    bool operator!=(CountingAllocator<T> const &, CountingAllocator<U> const &)
+    {
+        return false;
+    }
+}
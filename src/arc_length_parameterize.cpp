@@ -8,45 +8,86 @@
  */
 
 #include "arc_length_parameterize.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARC_LENGTH_SSE 1
+#include <emmintrin.h>
+#endif
 
 namespace modelling {
 
+	namespace {
+		// the Catmull-Rom cubic at t between p[1] and p[2]
+		inline float catmullRom(float const* p, float t) {
+			float m0 = 0.5f * (p[2] - p[0]);
+			float m1 = 0.5f * (p[3] - p[1]);
+			float d = p[2] - p[1];
+			float c3 = m0 + m1 - 2.f * d;
+			float c2 = d - m0 - c3;
+			return p[1] + t * (m0 + t * (c2 + t * c3));
+		}
+	}
+
 	ArcLengthTable::ArcLengthTable(float deltaS) : m_delta_s(deltaS) { assert(deltaS > 0); }
 
-	void ArcLengthTable::addNext(float u) { m_values.push_back(u); }
+	void ArcLengthTable::addNext(float u) {
+		m_values.push_back(u);
+		m_size++;
+	}
 
-	void ArcLengthTable::reserve_memory(size_t n) { m_values.reserve(n); }
+	void ArcLengthTable::reserve_memory(size_t n, size_t length_samples) {
+		m_values.reserve(n + 1);
+		m_pending_lengths.reserve(length_samples);
+		m_lengths.reserve(length_samples + 2);
+	}
 
-	float ArcLengthTable::deltaS() const { return m_delta_s; }
+	void ArcLengthTable::finish() {
+		m_values.push_back(1.f);
+		m_values.finish();
+
+		// pad the lengths with the segment start before U = 0 and the one after U = 1
+		assert(m_pending_lengths.size() > 1);
+		size_t n = m_pending_lengths.size() - 1;
+		float length = m_pending_lengths[n];
+		m_lengths.push_back(m_pending_lengths[n - 1] - length);
+		for (float s : m_pending_lengths)
+			m_lengths.push_back(s);
+		m_lengths.push_back(length + m_pending_lengths[1]);
+		m_lengths.finish();
+		m_pending_lengths = std::vector<float>();
+	}
 
-	size_t ArcLengthTable::size() const { return m_values.size(); }
+	void ArcLengthTable::addNextLength(float s) { m_pending_lengths.push_back(s); }
 
-	float ArcLengthTable::length() const { return size() * deltaS(); }
+	size_t ArcLengthTable::lengthSamples() const { return m_lengths.size() - 2; }
 
-	ArcLengthTable::iterator ArcLengthTable::begin() {
-		return std::begin(m_values);
-	}
+	float ArcLengthTable::deltaS() const { return m_delta_s; }
 
-	ArcLengthTable::iterator ArcLengthTable::end() { return std::end(m_values); }
+	size_t ArcLengthTable::size() const { return m_size; }
 
-	ArcLengthTable::const_iterator ArcLengthTable::begin() const {
-		return std::begin(m_values);
-	}
+	float ArcLengthTable::length() const { return size() * deltaS(); }
 
-	ArcLengthTable::const_iterator ArcLengthTable::end() const {
-		return std::end(m_values);
-	}
+	float ArcLengthTable::value(size_t i) const { return m_values[i]; }
+
+	size_t ArcLengthTable::bytes() const { return m_values.bytes() + m_lengths.bytes(); }
 
 	//***** STUDENTS TO-DO *****//
 	// Gets the nearest sample U at s
 	float ArcLengthTable::nearestValueTo(float s) const {
-		return 0;
+		assert(m_size > 0);
+		// round to the nearest entry, the entry past the last one is the first again
+		size_t index = size_t(std::floor(WrapS(s) / m_delta_s + 0.5f));
+		return m_values[index % m_size];
 	}
 	//***** ******** ***** *****//
 
 	//***** STUDENTS TO-DO *****//
 	// Gets the U value (linearly calculated) at s
 	float ArcLengthTable::operator()(float s) const {
+		METRICS_ADD(TABLE_LOOKUPS, 1);
 
 		// wrap s value to ensure s in [0, arc length]
 		s = WrapS(s);
@@ -54,30 +95,104 @@ namespace modelling {
 		size_t index_a = size_t(std::floor(s / m_delta_s));
 		// get the segment s value
 		float s_seg = (s/m_delta_s) - float(index_a);
-		// ensure that the indices wrap around
-		index_a = index_a % m_values.size();
-
-		// get the u values
-		float u_a = m_values[index_a];
-		float u_b;
-		// special case for last index
-		if(index_a == (m_values.size()-1))
-		{
-			u_b = 1.0f;
-		}
-		else
-		{
-			u_b = m_values[index_a+1];
-		}
-		
-		// interpolate the values
-		float u = (u_b - u_a) * s_seg + u_a;
+		// s is already wrapped, this only catches rounding at the very end (a clamp, not a slow modulo)
+		index_a = std::min(index_a, m_size - 1);
+
+		// interpolate the u values (the entry after the last one is U = 1)
+		float u = m_values.lerp(index_a, s_seg);
 
 		//printf("index_a: %d, index b: %d, s_seg: %10.3f, u_a: %10.7f, u_b: %10.7f, u: %10.7f\n", index_a, index_b, s_seg, u_a, u_b, u);
 		return u;
 	}
 	//***** ******** ***** *****//
 
+	void ArcLengthTable::operator()(float const* s, float* U, size_t count) const {
+		METRICS_ADD(TABLE_LOOKUPS, count);
+		for (size_t i = 0; i < count; i++)
+		{
+			// wrap and interpolate like operator()
+			float x = WrapS(s[i]) / m_delta_s;
+			size_t index_a = size_t(x);
+			float t = x - float(index_a);
+			U[i] = m_values.lerp(std::min(index_a, m_size - 1), t);
+		}
+	}
+
+	float ArcLengthTable::sAt(float U) const {
+		float s;
+		sAt(&U, &s, 1);
+		return s;
+	}
+
+	void ArcLengthTable::sAt(float const* U, float* s, size_t count) const {
+		assert(m_lengths.size() > 3);
+		size_t segments = m_lengths.size() - 3;
+		size_t i = 0;
+#ifdef ARC_LENGTH_SSE
+		// four at a time, the arithmetic of the cubic is most of the work once the starts are loaded
+		__m128 n = _mm_set1_ps(float(segments));
+		__m128i last = _mm_set1_epi32(int(segments - 1));
+		for (; i + 4 <= count; i += 4)
+		{
+			// wrap U value to ensure U in [0, 1) (truncation rounds negative values up, step those back down)
+			__m128 u = _mm_loadu_ps(U + i);
+			__m128 whole = _mm_cvtepi32_ps(_mm_cvttps_epi32(u));
+			whole = _mm_sub_ps(whole, _mm_and_ps(_mm_cmplt_ps(u, whole), _mm_set1_ps(1.f)));
+			__m128 x = _mm_mul_ps(_mm_sub_ps(u, whole), n);
+			__m128i seg = _mm_cvttps_epi32(x);
+			__m128i over = _mm_cmpgt_epi32(seg, last);
+			seg = _mm_or_si128(_mm_and_si128(over, last), _mm_andnot_si128(over, seg));
+			__m128 t = _mm_sub_ps(x, _mm_cvtepi32_ps(seg));
+
+			// the padding puts the start of segment seg at seg + 1, so the four starts around it begin at seg
+			alignas(16) int32_t index[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(index), seg);
+			QuantizedArray<3>::Run a = m_lengths.run(size_t(index[0]));
+			QuantizedArray<3>::Run b = m_lengths.run(size_t(index[1]));
+			QuantizedArray<3>::Run c = m_lengths.run(size_t(index[2]));
+			QuantizedArray<3>::Run d = m_lengths.run(size_t(index[3]));
+			// each lane's four offsets are 8 bytes in a row, transpose them into p0..p3 and widen to floats
+			__m128i ab = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(a.offsets)),
+											_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.offsets)));
+			__m128i cd = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(c.offsets)),
+											_mm_loadl_epi64(reinterpret_cast<__m128i const*>(d.offsets)));
+			__m128i p01 = _mm_unpacklo_epi32(ab, cd);
+			__m128i p23 = _mm_unpackhi_epi32(ab, cd);
+			__m128i zero = _mm_setzero_si128();
+			__m128 p0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(p01, zero));
+			__m128 p1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(p01, zero));
+			__m128 p2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(p23, zero));
+			__m128 p3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(p23, zero));
+
+			// catmullRom on all four (on the offsets, the cubic is linear in the starts so it decodes afterwards)
+			__m128 half = _mm_set1_ps(0.5f);
+			__m128 m0 = _mm_mul_ps(half, _mm_sub_ps(p2, p0));
+			__m128 m1 = _mm_mul_ps(half, _mm_sub_ps(p3, p1));
+			__m128 dp = _mm_sub_ps(p2, p1);
+			__m128 c3 = _mm_sub_ps(_mm_add_ps(m0, m1), _mm_add_ps(dp, dp));
+			__m128 c2 = _mm_sub_ps(_mm_sub_ps(dp, m0), c3);
+			__m128 r = _mm_add_ps(c2, _mm_mul_ps(t, c3));
+			r = _mm_add_ps(m0, _mm_mul_ps(t, r));
+			r = _mm_add_ps(p1, _mm_mul_ps(t, r));
+
+			__m128 base = _mm_setr_ps(a.base, b.base, c.base, d.base);
+			__m128 scale = _mm_setr_ps(a.scale, b.scale, c.scale, d.scale);
+			_mm_storeu_ps(s + i, _mm_add_ps(base, _mm_mul_ps(scale, r)));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			// wrap U value to ensure U in [0, 1)
+			float u = U[i] - std::floor(U[i]);
+			float x = u * float(segments);
+			size_t seg = std::min(size_t(x), segments - 1);
+			// the padding puts the start of segment seg at seg + 1, so the four starts around it begin at seg
+			QuantizedArray<3>::Run run = m_lengths.run(seg);
+			float p[4] = {float(run.offsets[0]), float(run.offsets[1]), float(run.offsets[2]), float(run.offsets[3])};
+			s[i] = run.base + run.scale * catmullRom(p, x - float(seg));
+		}
+	}
+
 	size_t ArcLengthTable::indexAt(float s) const {
 		// Assuming s in [0, length) since private function
 		return size_t(s / m_delta_s);
@@ -88,61 +203,92 @@ namespace modelling {
 	// maybe set delta_u based on the number of controll points (we want their to be more u steps than controll points)
 	// delta_u should correspond to a smaller jump in position than delta_s
 	// 1/num_control_points = 
-	ArcLengthTable calculateArcLengthTable(HermiteCurve const& curve, float delta_s, float delta_u) 
+	template <class CurveT>
+	ArcLengthTable calculateArcLengthTable(CurveT const& curve, float delta_s, float delta_u) 
+	{
+		ArcLengthTableBuilder builder(curve, delta_s, delta_u);
+		builder.advance(curve, SIZE_MAX);
+		return builder.take();
+	}
+
+	template <class CurveT>
+	ArcLengthTableBuilder::ArcLengthTableBuilder(CurveT const& curve, float delta_s, float delta_u)
+		: m_table(delta_s), m_delta_s(delta_s), m_delta_u(delta_u)
 	{
 		assert(curve.controlPoints().size() > 0);
 		assert(delta_s > 0.f);
 		assert(delta_u > 0.f);
 
-		ArcLengthTable table(delta_s); // this creates a table and sets the delta_s value
-		//Loop here to fill table
-
-		// get the arc-length
-		float arc_length = curve.arcLength(delta_u);
-		table.arc_length = arc_length;
-		
-		float u = 0; // the current u position
-		float s = 0; // the current s position
-		size_t num_points = size_t(std::ceil(arc_length / delta_s)); // the number of points in the table is the arclength divided by the s step
-		table.reserve_memory(num_points);
+		// the arc length is only known at the end, the control polygon is a close estimate of the table size
+		CurveControlPoints const& cps = curve.controlPoints();
+		float polygon_length = 0.f;
+		for (size_t i = 0; i < cps.size(); i++)
+			polygon_length += glm::length(cps[(i + 1) % cps.size()].position - cps[i].position);
+		m_segments = cps.size();
 
-		//printf("num_controll points: %d, arc length: %7.2f, delta s: %8.6f, delta_u: %8.6f, num_s_points: %d\n",curve.size(), arc_length, delta_s, delta_u, num_points);
+		m_table.reserve_memory(size_t(std::ceil(1.0625f * polygon_length / delta_s)) + 1, m_segments + 1);
 
-		size_t num_u = 1.0 / delta_u;
-		size_t s_index = 0;
-
-		// the maximum height and position at which it occurs in the curve
-		float H = curve(0.0f).y;
-		float s_H = 0.0f;
+		m_p = curve(0.0f);
+		m_H = m_p.y;
+	}
 
+	template <class CurveT>
+	bool ArcLengthTableBuilder::advance(CurveT const& curve, size_t max_steps)
+	{
 		// create the table
-		for(float u = 0; u < 1.0f; u += delta_u)
+		for (size_t step = 0; step < max_steps && m_u < 1.0f; step++)
 		{
 			// try to find the maximum height 
-			float temp = curve(u).y;
-			if(temp > H)
+			if (m_p.y > m_H)
 			{
-				H = temp;
-				s_H = s;
+				m_H = m_p.y;
+				m_s_H = float(m_s);
 			}
 
-			// increment the position of s
-			s = s + glm::length(curve(u + delta_u) - curve(u));
+			// increment the position of s (the next point is the start of the next step)
+			double next_u = m_u + m_delta_u;
+			glm::vec3 next = curve(float(next_u));
+			float step_length = glm::length(next - m_p);
+
+			// record the length at every segment start this step passes, interpolated along the step
+			for (double grid_u = double(m_length_index) / double(m_segments);
+				m_length_index <= m_segments && grid_u <= next_u;
+				grid_u = double(++m_length_index) / double(m_segments))
+			{
+				m_table.addNextLength(float(m_s + step_length * (grid_u - m_u) / (next_u - m_u)));
+			}
+
+			m_s = m_s + step_length;
 			// if this is past the next position then store the u value
-			if(s > (float(s_index)*delta_s))
+			if (m_s > double(m_s_index) * m_delta_s)
 			{
-				//printf("Table: %d : %10.7f at s: %10.3f\n", s_index, u, s);
 				// add the next u value
-				table.addNext(u);
+				m_table.addNext(float(m_u));
 				// increment the s index
-				s_index++;
+				m_s_index++;
 			}
+			m_p = next;
+			m_u += m_delta_u;
 		}
+		return done();
+	}
+
+	bool ArcLengthTableBuilder::done() const { return m_u >= 1.0f; }
 
-		table.max_height = H;
-		table.s_max_height = s_H;
+	float ArcLengthTableBuilder::progress() const { return float(std::min(m_u, 1.0)); }
 
-		return table;
+	ArcLengthTable ArcLengthTableBuilder::take()
+	{
+		assert(done());
+		// the sum of the steps is the arc length of the curve at this delta_u
+		m_table.arc_length = float(m_s);
+		// the end of the last segment (U = 1) can be a rounding error past the last step
+		for (; m_length_index <= m_segments; m_length_index++)
+			m_table.addNextLength(float(m_s));
+		m_table.finish();
+		m_table.max_height = m_H;
+		m_table.s_max_height = m_s_H;
+		return std::move(m_table);
 	}
 
 	float ArcLengthTable::WrapS(float s) const
@@ -176,4 +322,15 @@ namespace modelling {
 	}
 
 	//***** ******** ***** *****//
-} // namespace modelling
\ No newline at end of file
+
+	// the curve types of hermite_curve.hpp, the curve is a template parameter so the u walk inlines its evaluation
+	template ArcLengthTable calculateArcLengthTable(HermiteCurve const&, float, float);
+	template ArcLengthTable calculateArcLengthTable(BSplineCurve const&, float, float);
+	template ArcLengthTable calculateArcLengthTable(BezierCurve const&, float, float);
+	template ArcLengthTableBuilder::ArcLengthTableBuilder(HermiteCurve const&, float, float);
+	template ArcLengthTableBuilder::ArcLengthTableBuilder(BSplineCurve const&, float, float);
+	template ArcLengthTableBuilder::ArcLengthTableBuilder(BezierCurve const&, float, float);
+	template bool ArcLengthTableBuilder::advance(HermiteCurve const&, size_t);
+	template bool ArcLengthTableBuilder::advance(BSplineCurve const&, size_t);
+	template bool ArcLengthTableBuilder::advance(BezierCurve const&, size_t);
+} // namespace modelling
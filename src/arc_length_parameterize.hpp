@@ -10,15 +10,18 @@
 #pragma once
 
 #include "hermite_curve.hpp"
+#include "quantized_array.hpp"
 #include <glm/glm.hpp>
 #include <vector>
+
 namespace modelling {
+	/**
+	 * The U values and the segment start lengths for the inverse are stored quantized to 16 bits per entry
+	 * (see QuantizedArray), about half the memory of floats with an error far below the table's own. sAt works on
+	 * the encoded starts and decodes the result once, so the quantization costs it one multiply-add.
+	 */
 	class ArcLengthTable {
 	public:
-		using table_t = std::vector<float>;
-		using iterator = table_t::iterator;
-		using const_iterator = table_t::const_iterator;
-
 		ArcLengthTable() = default;
 		explicit ArcLengthTable(float deltaS);
 
@@ -27,12 +30,14 @@ namespace modelling {
 		float length() const;
 
 		void addNext(float t);
-		void reserve_memory(size_t n);
+		void reserve_memory(size_t n, size_t length_samples = 0);
+		// call once every value and length is added, before any lookups
+		void finish();
 
-		iterator begin();
-		iterator end();
-		const_iterator begin() const;
-		const_iterator end() const;
+		// the U value of entry i
+		float value(size_t i) const;
+		// the bytes held by the quantized values and lengths
+		size_t bytes() const;
 
 		//***** STUDENTS TO-DO *****//
 		// Gets the nearest sample U at s
@@ -44,6 +49,24 @@ namespace modelling {
 		float operator()(float s) const;
 		//***** ******** ***** *****//
 
+		// Gets the U values at count s values (the same as operator() for each)
+		void operator()(float const* s, float* U, size_t count) const;
+
+		/**
+		 * Gets the s value at U (the inverse of operator()). The cumulative length is kept at the start of every
+		 * segment, U picks its segment directly and s is a Catmull-Rom cubic through the four nearest starts
+		 * (s(U) is smooth, so this stays within a few hundredths of a unit where a lerp is off by a tenth or more).
+		 */
+		float sAt(float U) const;
+
+		// Gets the s values at count U values (the same as sAt for each)
+		void sAt(float const* U, float* s, size_t count) const;
+
+		// the cumulative length at the start of each segment (U = i / n), the last entry is the arc length at U = 1
+		void addNextLength(float s);
+		// the number of segment start lengths (segments + 1)
+		size_t lengthSamples() const;
+
 		float arc_length = 0.0; // this is the arc length that was used in the calculation of this table
 		float max_height = 0; // the maximum height encountered along the curve
 		float s_max_height = 0; // the s coordinate of the maximum height
@@ -52,8 +75,16 @@ namespace modelling {
 		void TestTable(float jump);
 
 	private:
-		table_t m_values;
+		// one entry per delta_s plus U = 1 at the end, so the entry after the last one needs no special case
+		QuantizedArray<> m_values;
+		size_t m_size = 0;
 		float m_delta_s = 1.f;
+		// the s value at U = (i - 1) / n, padded with the start before the first segment and after the last one
+		// (one lap back and ahead) so the cubic never wraps, every block repeats the 3 starts after it so the four
+		// starts around a segment always decode with one block
+		QuantizedArray<3> m_lengths;
+		// the starts as they are added, they are quantized once the padding before the first one is known
+		std::vector<float> m_pending_lengths;
 
 		size_t indexAt(float s) const;
 
@@ -63,10 +94,47 @@ namespace modelling {
 		float WrapS(float s) const;
 	};
 
+	// Builds an arc length table a number of u steps at a time, so the work can be spread over several frames
+	class ArcLengthTableBuilder {
+	public:
+		ArcLengthTableBuilder() = default;
+		// CurveT is any of the curves in hermite_curve.hpp
+		template <class CurveT>
+		ArcLengthTableBuilder(CurveT const& curve, float delta_s, float delta_u);
+
+		// walk up to max_steps more u steps along the curve the builder was made with, returns true once it is done
+		template <class CurveT>
+		bool advance(CurveT const& curve, size_t max_steps);
+		bool done() const;
+		// the fraction of the curve walked so far
+		float progress() const;
+
+		// hands over the finished table
+		ArcLengthTable take();
+
+	private:
+		ArcLengthTable m_table;
+		float m_delta_s = 1.f;
+		float m_delta_u = 1.f;
+
+		// doubles, on a long track the steps are too small to add up in a float (they round off or stop adding at all)
+		double m_u = 0.0; // the current u position
+		double m_s = 0.0; // the current s position
+		size_t m_s_index = 0;
+		size_t m_length_index = 0; // the next segment start to record the length at
+		size_t m_segments = 1;
+		glm::vec3 m_p; // the curve at m_u (each point is evaluated once)
+
+		// the maximum height and position at which it occurs in the curve
+		float m_H = 0.f;
+		float m_s_H = 0.f;
+	};
+
 	//***** STUDENTS TO-DO *****//
 	// Generates the ALP
+	template <class CurveT>
 	ArcLengthTable calculateArcLengthTable(
-		HermiteCurve const& curve, float delta_s, float delta_u
+		CurveT const& curve, float delta_s, float delta_u
 	);
 	//***** ******** ***** *****//
 
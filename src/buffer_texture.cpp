@@ -0,0 +1,38 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "buffer_texture.hpp"
+
+namespace rendering
+{
+    void BufferTexture::upload(glm::vec4 const *data, size_t count)
+    {
+        m_buffer.bind(GL_TEXTURE_BUFFER);
+        glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(count * sizeof(glm::vec4)), data, GL_STATIC_DRAW);
+        m_buffer.unbind(GL_TEXTURE_BUFFER);
+        m_size = count;
+
+        if (!m_attached)
+        {
+            m_texture.bind(GL_TEXTURE_BUFFER);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+            m_attached = true;
+        }
+    }
+
+    void BufferTexture::bind(GLuint unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        m_texture.bind(GL_TEXTURE_BUFFER);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t BufferTexture::size() const
+    {
+        return m_size;
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "givr.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+
+namespace rendering
+{
+    /**
+     * A GL_TEXTURE_BUFFER backed by its own buffer object, read in shaders with a samplerBuffer and texelFetch.
+     * Texture buffers are core in GL 3.1, but 3.3 only allows 1, 2 and 4 component formats so data is stored as vec4s.
+     */
+    class BufferTexture
+    {
+    public:
+        BufferTexture() = default;
+
+        BufferTexture(const BufferTexture &) = delete;
+        BufferTexture &operator=(const BufferTexture &) = delete;
+
+        /**
+         * replace the contents of the buffer (the texture is attached on the first upload)
+         * @param data the texels to upload
+         * @param count the number of texels
+         */
+        void upload(glm::vec4 const *data, size_t count);
+
+        // bind the texture to a texture unit (GL_TEXTURE0 + unit)
+        void bind(GLuint unit);
+
+        size_t size() const;
+
+    private:
+        givr::Buffer m_buffer;
+        givr::Texture m_texture;
+        size_t m_size = 0;
+        bool m_attached = false;
+    };
+}
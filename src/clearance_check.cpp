@@ -0,0 +1,162 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "clearance_check.hpp"
+#include "profiler.hpp"
+#include "spatial_hash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace modelling
+{
+    ClearanceReport checkClearance(RollerCoaster &roller_coaster, ClearanceSettings const &settings)
+    {
+        PROFILE_SCOPE("clearance check");
+        auto start = std::chrono::steady_clock::now();
+        ClearanceReport report;
+
+        float length = roller_coaster.ArcLength();
+        if (length <= 0.0f || settings.clearance <= 0.0f || settings.spacing <= 0.0f)
+        {
+            return report;
+        }
+
+        // sample the track on the s grid
+        size_t n = std::max(size_t(std::ceil(length / settings.spacing)), size_t(1));
+        float ds = length / float(n);
+        std::vector<glm::vec3> points(n);
+        roller_coaster.ParallelFor(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                points[i] = roller_coaster.GetPositionAtS(float(i) * ds);
+            }
+        });
+        report.samples = n;
+
+        SpatialHash hash(points, settings.clearance);
+
+        // the distance between two s positions along the loop
+        auto along = [length](float s_a, float s_b) {
+            float d = std::abs(s_a - s_b);
+            return std::min(d, length - d);
+        };
+
+        // the closest non neighbouring sample to each sample, written per sample so the chunks never share data
+        float clearance2 = settings.clearance * settings.clearance;
+        std::vector<float> min_distance(n, std::numeric_limits<float>::infinity());
+        std::vector<float> other_s(n, 0.0f);
+        roller_coaster.ParallelFor(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                float s_i = float(i) * ds;
+                float best = clearance2;
+                hash.forEachNear(points[i], [&](uint32_t j) {
+                    float s_j = float(j) * ds;
+                    glm::vec3 d = points[j] - points[i];
+                    float d2 = glm::dot(d, d);
+                    if (d2 < best && along(s_i, s_j) > settings.neighbour_s)
+                    {
+                        best = d2;
+                        other_s[i] = s_j;
+                    }
+                });
+                if (best < clearance2)
+                {
+                    min_distance[i] = std::sqrt(best);
+                }
+            }
+        });
+
+        // join neighbouring violating samples into stretches
+        bool open = false; // the previous sample violated as well
+        for (size_t i = 0; i < n; i++)
+        {
+            bool violates = std::isfinite(min_distance[i]);
+            bool extend = open && violates;
+            open = violates;
+            if (!violates)
+            {
+                continue;
+            }
+            float s_i = float(i) * ds;
+            if (extend)
+            {
+                ClearanceViolation &v = report.track.back();
+                v.s_end = s_i;
+                if (min_distance[i] < v.min_distance)
+                {
+                    v.min_distance = min_distance[i];
+                    v.other_s = other_s[i];
+                }
+            }
+            else
+            {
+                report.track.push_back(ClearanceViolation{s_i, s_i, other_s[i], min_distance[i]});
+            }
+        }
+        // a stretch running through s = 0 is one stretch (s_begin > s_end)
+        if (report.track.size() > 1 && report.track.front().s_begin == 0.0f && report.track.back().s_end == float(n - 1) * ds)
+        {
+            ClearanceViolation last = report.track.back();
+            report.track.pop_back();
+            ClearanceViolation &first = report.track.front();
+            first.s_begin = last.s_begin;
+            if (last.min_distance < first.min_distance)
+            {
+                first.min_distance = last.min_distance;
+                first.other_s = last.other_s;
+            }
+        }
+
+        // walk down each support column and look for track that is not the section the support holds up
+        std::pmr::vector<glm::mat4> const &supports = *roller_coaster.SupportTransforms();
+        float radius = std::min(settings.support_radius, settings.clearance);
+        float radius2 = radius * radius;
+        std::vector<SupportViolation> support_hits(supports.size(), SupportViolation{0, 0.0f, 0.0f, std::numeric_limits<float>::infinity()});
+        roller_coaster.ParallelFor(supports.size(), 16, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; k++)
+            {
+                glm::vec3 top = glm::vec3(supports[k][3]);
+                float support_s = roller_coaster.ClosestPointOnTrack(top).s;
+                SupportViolation &hit = support_hits[k];
+                hit.support = k;
+                hit.support_s = support_s;
+
+                float best = radius2;
+                for (float y = top.y; y >= -BASE_LEVEL; y -= settings.spacing)
+                {
+                    glm::vec3 p(top.x, y, top.z);
+                    hash.forEachNear(p, [&](uint32_t j) {
+                        float s_j = float(j) * ds;
+                        glm::vec3 d = points[j] - p;
+                        float d2 = glm::dot(d, d);
+                        if (d2 < best && along(support_s, s_j) > settings.neighbour_s)
+                        {
+                            best = d2;
+                            hit.track_s = s_j;
+                        }
+                    });
+                }
+                if (best < radius2)
+                {
+                    hit.min_distance = std::sqrt(best);
+                }
+            }
+        });
+        for (SupportViolation const &hit : support_hits)
+        {
+            if (std::isfinite(hit.min_distance))
+            {
+                report.supports.push_back(hit);
+            }
+        }
+
+        report.ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+}
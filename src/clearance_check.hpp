@@ -0,0 +1,56 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "RollerCoaster.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace modelling
+{
+    struct ClearanceSettings
+    {
+        float clearance = 2.0f;      // the closest two track sections may come
+        float neighbour_s = 8.0f;    // points closer than this along the track are neighbours, not a violation
+        float spacing = 0.5f;        // the s step of the samples (keep it below the clearance)
+        float support_radius = 0.5f; // how close track may come to a support column
+    };
+
+    // a stretch of track that comes too close to another part of the track
+    struct ClearanceViolation
+    {
+        float s_begin; // greater than s_end when the stretch runs through s = 0
+        float s_end;
+        float other_s;      // where the closest offending section is
+        float min_distance; // the smallest distance over the stretch
+    };
+
+    // a support column that passes through another part of the track
+    struct SupportViolation
+    {
+        size_t support;     // the index in the support transforms
+        float support_s;    // where the support holds the track
+        float track_s;      // the section it passes through
+        float min_distance;
+    };
+
+    struct ClearanceReport
+    {
+        std::vector<ClearanceViolation> track;
+        std::vector<SupportViolation> supports;
+        size_t samples = 0;
+        float ms = 0.0f; // how long the check took
+    };
+
+    /**
+     * Checks that the track never comes within the clearance of itself and that no support cuts through
+     * another section. The track is sampled on an s grid from the frame cache, the samples go into a uniform
+     * spatial hash with cells the size of the clearance, and each sample only looks at the 27 cells around it,
+     * so the check is close to linear in the track length. Sampling and queries run on the roller coaster's scheduler.
+     */
+    ClearanceReport checkClearance(RollerCoaster &roller_coaster, ClearanceSettings const &settings);
+}
@@ -0,0 +1,74 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ *
+ * Modified from provided Assignment 1 - Boilerplate
+ * @authors Copyright 2019 Lakin Wecker, Jeremy Hart, Andrew Owens and Others (see AUTHORS)
+ */
+
+#pragma once
+
+#include "curve_basis.hpp"
+#include <glm/glm.hpp>
+#include <memory_resource>
+#include <vector>
+#include "givr.h"
+
+namespace modelling {
+	/**
+	 * A closed piecewise cubic curve with one segment per control point. The basis (see curve_basis.hpp) is a
+	 * template parameter, so evaluation inlines down to that basis's polynomial with no dispatch at all.
+	 */
+	template <class Basis>
+	class Curve {
+	public:
+		using basis_type = Basis;
+		using ControlPoint = CurveControlPoint;
+		using ControlPoints = CurveControlPoints;
+		static ControlPoints
+			buildControlPoints(std::vector<glm::vec3> posistions);
+		static void calculateCatmullRomTangents(ControlPoints& cps);
+		static void calculateCanonicalTangents(ControlPoints& cps, float c);
+
+		Curve() = default;
+		explicit Curve(ControlPoints controlPoints);
+
+		glm::vec3 operator()(float U) const;
+		glm::vec3 position(float U) const;
+
+		ControlPoints const& controlPoints() const;
+		ControlPoints& controlPoints();
+
+		float arcLength(float dU) const;
+		std::pmr::vector<glm::vec3> sample(size_t number_of_samples,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+		//Render tracks
+		givr::geometry::MultiLine controlPointGeometry() const;
+		givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP>
+			controlPointFrameGeometry() const;
+		givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP>
+			sampledGeometry(size_t number_of_samples) const;
+
+		size_t size() const;
+
+		// the smallest distance between any two consecutive points in the curve
+		float minSeperation() const;
+		// the largest distance between any two consecutive points in the curve
+		float maxSeperation() const;
+
+	private:
+		ControlPoints m_cps;
+
+		std::pair<float, size_t> localize(float U) const;
+
+		//***** STUDENTS TO-DO *****//
+		// Gets the position at U (global parameter)
+		glm::vec3 positionInSegment(std::pair<float, size_t> u_seg) const;
+		//***** ******** ***** *****//
+	};
+
+} // namespace modelling
+
+#include "curve.tpp"
@@ -0,0 +1,189 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ *
+ * Modified from provided Assignment 1 - Boilerplate
+ * @authors Copyright 2019 Lakin Wecker, Jeremy Hart, Andrew Owens and Others (see AUTHORS)
+ */
+
+// included at the end of curve.hpp
+
+#include "frame_arena.hpp"
+#include "metrics.hpp"
+#include <utility>
+
+namespace modelling {
+
+	template <class Basis>
+	typename Curve<Basis>::ControlPoints
+	Curve<Basis>::buildControlPoints(std::vector<glm::vec3> posistions) {
+		ControlPoints cps(posistions.size());
+		for (int i = 0; i < posistions.size(); i++)
+			cps[i].position = posistions[i];
+		calculateCatmullRomTangents(cps);
+		return cps;
+	}
+	template <class Basis>
+	void Curve<Basis>::calculateCatmullRomTangents(ControlPoints& cps) {
+		calculateCanonicalTangents(cps, 0.0f);
+	}
+	template <class Basis>
+	void Curve<Basis>::calculateCanonicalTangents(ControlPoints& cps, float c) {
+		float constant = (1.f - c) / 2.f;
+		for (int index = 0; index < cps.size(); index++) {
+			const ControlPoint& cp_previous = cps[index == 0 ? cps.size() - 1 : index - 1];
+			const ControlPoint& cp_next     = cps[index == cps.size() - 1 ? 0 : index + 1];
+			cps[index].tangent = constant * (cp_next.position - cp_previous.position);
+		}
+	}
+
+	template <class Basis>
+	Curve<Basis>::Curve(ControlPoints controlPoints)
+		: m_cps(std::move(controlPoints)) {}
+
+	// evaluate curve at u (inline so it still inlines where the instantiation is extern)
+	template <class Basis>
+	inline glm::vec3 Curve<Basis>::operator()(float U) const {
+		assert(m_cps.size() > 0);
+		METRICS_ADD(CURVE_EVALUATIONS, 1);
+		//Ensure U in [0,1) wrapped (1.1 -> 0.1 and -1.1 -> 0.9)
+		U = std::fmod(U, 1.f);
+		if (U < 0) U = std::fmod(1.f + U, 1.f);
+		//Evaluate
+		return positionInSegment(localize(U));
+	}
+	template <class Basis>
+	inline glm::vec3 Curve<Basis>::position(float U) const {
+		return operator()(U);
+	}
+
+	template <class Basis>
+	inline typename Curve<Basis>::ControlPoints const& Curve<Basis>::controlPoints() const {
+		return m_cps;
+	}
+	template <class Basis>
+	inline typename Curve<Basis>::ControlPoints& Curve<Basis>::controlPoints() { return m_cps; }
+
+	template <class Basis>
+	float Curve<Basis>::arcLength(float dU) const {
+		assert(m_cps.size() > 0);
+		assert(dU > 0.f);
+		float l = 0.f;
+		for (float u = 0.f; u < 1.f; u += dU) {
+			l += glm::length(position(u + dU) - position(u));
+		}
+		return l;
+	}
+
+	template <class Basis>
+	std::pmr::vector<glm::vec3> Curve<Basis>::sample(size_t number_of_samples,
+		std::pmr::memory_resource* resource) const {
+		assert(m_cps.size() > 0);
+		if (number_of_samples == 0) return std::pmr::vector<glm::vec3>(resource);
+		if (number_of_samples == 1) return std::pmr::vector<glm::vec3>(1, position(0.f), resource);
+
+		std::pmr::vector<glm::vec3> samples(number_of_samples, resource);
+		float dU = 1.f / float(number_of_samples - 1);
+		for (int i = 0; i < number_of_samples; i++)
+			samples[i] = position(i * dU);
+
+		return samples;
+	}
+
+	template <class Basis>
+	givr::geometry::MultiLine Curve<Basis>::controlPointGeometry() const {
+		givr::geometry::MultiLine vectors;
+		for (auto const& cp : m_cps) {
+			vectors.push_back({ 
+				givr::geometry::Point1(cp.position),
+				givr::geometry::Point2(cp.position + cp.tangent)
+			});
+		}
+		return vectors;
+	}
+
+	template <class Basis>
+	givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP>
+	Curve<Basis>::controlPointFrameGeometry() const {
+		givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP> geometry;
+		for (auto const& cp : m_cps)
+			geometry.push_back(givr::geometry::Point(cp.position));
+		return geometry;
+	}
+
+	template <class Basis>
+	givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP>
+	Curve<Basis>::sampledGeometry(size_t number_of_samples) const {
+		givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP> geometry;
+		for (auto const& p : sample(number_of_samples, memory::rebuildResource()))
+			geometry.push_back(givr::geometry::Point(p));
+		return geometry;
+	}
+
+	template <class Basis>
+	inline std::pair<float, size_t> Curve<Basis>::localize(float U) const {
+		// Assuming U in [0,1) since private funtion
+		float float_seg = U * m_cps.size();
+		size_t seg = size_t(std::floor(float_seg));
+		float u = float_seg - seg;
+		return { u, seg };
+	}
+
+	//***** STUDENTS TO-DO *****//
+	// Gets the position at U (global parameter)
+	template <class Basis>
+	inline glm::vec3 Curve<Basis>::positionInSegment(std::pair<float, size_t> u_seg) const {
+		// Assuming u in [0,1] and seg in [0, num_cp) since private funtion
+		glm::vec3 G[4];
+		Basis::geometry(m_cps, u_seg.second, G);
+		return evaluateSegment<Basis>(G, u_seg.first);
+	}
+	//***** ******** ***** *****//
+
+	template <class Basis>
+	inline size_t Curve<Basis>::size() const
+	{
+		return m_cps.size();
+	}
+
+	template <class Basis>
+	float Curve<Basis>::minSeperation() const
+	{
+		// loop through controll points to find the minimum seperation distance between consecutive points
+		glm::vec3 v = (m_cps[0].position - m_cps[m_cps.size() - 1].position); 
+		float min_dist = v.x*v.x + v.y*v.y + v.z*v.z;
+
+		for(size_t i = 0; i < m_cps.size()-1; i++)
+		{
+			v = (m_cps[i].position - m_cps[i+1].position);
+			float temp = v.x * v.x + v.y * v.y + v.z * v.z;
+			if(temp < min_dist)
+			{
+				min_dist = temp;
+			}
+		}
+
+		return glm::sqrt(min_dist);
+	}
+
+	template <class Basis>
+	float Curve<Basis>::maxSeperation() const
+	{
+		// loop through control points to find the maximum seperation distance between consecutive points
+		glm::vec3 v = (m_cps[0].position - m_cps[m_cps.size() - 1].position);
+		float max_dist = v.x * v.x + v.y * v.y + v.z * v.z;
+
+		for (size_t i = 0; i < m_cps.size() - 1; i++)
+		{
+			v = (m_cps[i].position - m_cps[i + 1].position);
+			float temp = v.x * v.x + v.y * v.y + v.z * v.z;
+			if (temp > max_dist)
+			{
+				max_dist = temp;
+			}
+		}
+
+		return glm::sqrt(max_dist);
+	}
+} // namespace modelling
\ No newline at end of file
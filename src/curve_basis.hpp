@@ -0,0 +1,129 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "alloc_counter.hpp"
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace modelling
+{
+    // a control point of a closed curve, every basis reads the same points (the B-spline ignores the tangents)
+    struct CurveControlPoint
+    {
+        glm::vec3 position;
+        glm::vec3 tangent;
+    };
+    // counted so the tests can check how many control point buffers a load makes (memory::bufferAllocations)
+    using CurveControlPoints = std::vector<CurveControlPoint, memory::CountingAllocator<CurveControlPoint>>;
+
+    /*
+     * A basis turns the 4 geometry vectors G of segment i into a cubic: C(u) = sum over k and j of
+     * matrix[k][j] u^k G[j]. The matrices are constexpr so evaluateSegment folds the zeros away and every
+     * basis compiles down to its own hand written polynomial.
+     */
+
+    // G = (P_i, P_i+1, T_i, T_i+1), passes through every control point with the given tangents
+    struct HermiteBasis
+    {
+        static constexpr float matrix[4][4] = {
+            {1.0f, 0.0f, 0.0f, 0.0f},
+            {0.0f, 0.0f, 1.0f, 0.0f},
+            {-3.0f, 3.0f, -2.0f, -1.0f},
+            {2.0f, -2.0f, 1.0f, 1.0f},
+        };
+
+        static void geometry(CurveControlPoints const &cps, size_t seg, glm::vec3 (&G)[4])
+        {
+            CurveControlPoint const &a = cps[seg];
+            CurveControlPoint const &b = cps[(seg + 1) % cps.size()];
+            G[0] = a.position;
+            G[1] = b.position;
+            G[2] = a.tangent;
+            G[3] = b.tangent;
+        }
+    };
+
+    // G = (P_i-1, P_i, P_i+1, P_i+2), C2 continuous but only passes near the control points
+    struct BSplineBasis
+    {
+        static constexpr float matrix[4][4] = {
+            {1.0f / 6.0f, 4.0f / 6.0f, 1.0f / 6.0f, 0.0f},
+            {-3.0f / 6.0f, 0.0f, 3.0f / 6.0f, 0.0f},
+            {3.0f / 6.0f, -6.0f / 6.0f, 3.0f / 6.0f, 0.0f},
+            {-1.0f / 6.0f, 3.0f / 6.0f, -3.0f / 6.0f, 1.0f / 6.0f},
+        };
+
+        static void geometry(CurveControlPoints const &cps, size_t seg, glm::vec3 (&G)[4])
+        {
+            size_t n = cps.size();
+            G[0] = cps[(seg + n - 1) % n].position;
+            G[1] = cps[seg].position;
+            G[2] = cps[(seg + 1) % n].position;
+            G[3] = cps[(seg + 2) % n].position;
+        }
+    };
+
+    // G = (P_i, P_i + T_i / 3, P_i+1 - T_i+1 / 3, P_i+1), the same curve as Hermite through its Bezier handles
+    struct BezierBasis
+    {
+        static constexpr float matrix[4][4] = {
+            {1.0f, 0.0f, 0.0f, 0.0f},
+            {-3.0f, 3.0f, 0.0f, 0.0f},
+            {3.0f, -6.0f, 3.0f, 0.0f},
+            {-1.0f, 3.0f, -3.0f, 1.0f},
+        };
+
+        static void geometry(CurveControlPoints const &cps, size_t seg, glm::vec3 (&G)[4])
+        {
+            CurveControlPoint const &a = cps[seg];
+            CurveControlPoint const &b = cps[(seg + 1) % cps.size()];
+            G[0] = a.position;
+            G[1] = a.position + a.tangent / 3.0f;
+            G[2] = b.position - b.tangent / 3.0f;
+            G[3] = b.position;
+        }
+    };
+
+    // the point at u in [0, 1] of the segment with geometry G
+    template <class Basis>
+    inline glm::vec3 evaluateSegment(glm::vec3 const (&G)[4], float u)
+    {
+        // written out so every matrix entry is a constant the compiler can fold
+        constexpr auto &M = Basis::matrix;
+        float w0 = M[0][0] + u * (M[1][0] + u * (M[2][0] + u * M[3][0]));
+        float w1 = M[0][1] + u * (M[1][1] + u * (M[2][1] + u * M[3][1]));
+        float w2 = M[0][2] + u * (M[1][2] + u * (M[2][2] + u * M[3][2]));
+        float w3 = M[0][3] + u * (M[1][3] + u * (M[2][3] + u * M[3][3]));
+        return w0 * G[0] + w1 * G[1] + w2 * G[2] + w3 * G[3];
+    }
+
+    // the power form of the segment, C(u) = c[0] + c[1] u + c[2] u^2 + c[3] u^3
+    template <class Basis>
+    inline void powerCoefficients(glm::vec3 const (&G)[4], glm::vec3 (&c)[4])
+    {
+        for (size_t k = 0; k < 4; k++)
+        {
+            c[k] = Basis::matrix[k][0] * G[0] + Basis::matrix[k][1] * G[1] + Basis::matrix[k][2] * G[2] + Basis::matrix[k][3] * G[3];
+        }
+    }
+
+    // the Bezier control points of segment seg in any basis, the curve stays inside their convex hull
+    template <class Basis>
+    inline void segmentBezier(CurveControlPoints const &cps, size_t seg, glm::vec3 (&b)[4])
+    {
+        glm::vec3 G[4];
+        glm::vec3 c[4];
+        Basis::geometry(cps, seg, G);
+        powerCoefficients<Basis>(G, c);
+        b[0] = c[0];
+        b[1] = c[0] + c[1] / 3.0f;
+        b[2] = c[0] + (2.0f * c[1] + c[2]) / 3.0f;
+        b[3] = c[0] + c[1] + c[2] + c[3];
+    }
+}
@@ -0,0 +1,416 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "curve_bvh.hpp"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace modelling
+{
+    namespace
+    {
+        // cubic Bezier position and its first two derivatives at u
+        glm::vec3 bezier(glm::vec3 const *b, float u)
+        {
+            float v = 1.0f - u;
+            return b[0] * (v * v * v) + b[1] * (3.0f * v * v * u) + b[2] * (3.0f * v * u * u) + b[3] * (u * u * u);
+        }
+
+        glm::vec3 bezierDerivative(glm::vec3 const *b, float u)
+        {
+            float v = 1.0f - u;
+            return 3.0f * ((b[1] - b[0]) * (v * v) + (b[2] - b[1]) * (2.0f * v * u) + (b[3] - b[2]) * (u * u));
+        }
+
+        glm::vec3 bezierSecondDerivative(glm::vec3 const *b, float u)
+        {
+            return 6.0f * ((b[2] - 2.0f * b[1] + b[0]) * (1.0f - u) + (b[3] - 2.0f * b[2] + b[1]) * u);
+        }
+
+        // the squared distance from p to a box (zero inside)
+        float boxDistance2(glm::vec3 const &lo, glm::vec3 const &hi, glm::vec3 const &p)
+        {
+            glm::vec3 d = glm::max(glm::max(lo - p, p - hi), glm::vec3(0.0f));
+            return glm::dot(d, d);
+        }
+
+        // the ray distance where it enters a box grown by radius, or infinity if it misses
+        float boxEntry(glm::vec3 const &lo, glm::vec3 const &hi, float radius, glm::vec3 const &origin, glm::vec3 const &inv_dir)
+        {
+            glm::vec3 t0 = (lo - radius - origin) * inv_dir;
+            glm::vec3 t1 = (hi + radius - origin) * inv_dir;
+            glm::vec3 t_min = glm::min(t0, t1);
+            glm::vec3 t_max = glm::max(t0, t1);
+            float t_near = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+            float t_far = std::min(std::min(t_max.x, t_max.y), t_max.z);
+            return t_near <= t_far ? t_near : std::numeric_limits<float>::infinity();
+        }
+
+        /**
+         * minimize a squared distance over u in [0, 1]: coarse samples find the right basin, Newton steps polish it
+         * @param distance2 returns the squared distance at u
+         * @param derivatives sets the first and second derivative of the squared distance at u
+         */
+        template <typename Distance2, typename Derivatives>
+        float minimizeOnSegment(Distance2 distance2, Derivatives derivatives, float &best_d2)
+        {
+            float best_u = 0.0f;
+            best_d2 = std::numeric_limits<float>::infinity();
+            for (int i = 0; i <= BVH_SEGMENT_SAMPLES; i++)
+            {
+                float u = float(i) / float(BVH_SEGMENT_SAMPLES);
+                float d2 = distance2(u);
+                if (d2 < best_d2)
+                {
+                    best_d2 = d2;
+                    best_u = u;
+                }
+            }
+
+            float u = best_u;
+            for (int i = 0; i < BVH_NEWTON_STEPS; i++)
+            {
+                float d1, dd;
+                derivatives(u, d1, dd);
+                if (dd <= 0.0f)
+                {
+                    break;
+                }
+                u = std::clamp(u - d1 / dd, 0.0f, 1.0f);
+            }
+
+            // Newton can walk out of the basin near an inflection, only keep it if it helped
+            float d2 = distance2(u);
+            if (d2 < best_d2)
+            {
+                best_d2 = d2;
+                best_u = u;
+            }
+            return best_u;
+        }
+    }
+
+    template <class Basis>
+    CurveBVH::CurveBVH(Curve<Basis> const &curve)
+    {
+        CurveControlPoints const &cps = curve.controlPoints();
+        m_curve_size = cps.size();
+        if (cps.empty())
+        {
+            return;
+        }
+
+        // the Bezier form of each segment, its control points bound it
+        std::vector<Segment> segments(cps.size());
+        std::vector<glm::vec3> centroids(cps.size());
+        std::vector<uint32_t> order(cps.size());
+        for (size_t i = 0; i < cps.size(); i++)
+        {
+            Segment &seg = segments[i];
+            toBezier<Basis>(cps, i, seg);
+
+            glm::vec3 lo = glm::min(glm::min(seg.b[0], seg.b[1]), glm::min(seg.b[2], seg.b[3]));
+            glm::vec3 hi = glm::max(glm::max(seg.b[0], seg.b[1]), glm::max(seg.b[2], seg.b[3]));
+            centroids[i] = 0.5f * (lo + hi);
+            order[i] = uint32_t(i);
+        }
+
+        // a binary tree with small leaves has fewer than 2n / leaf size nodes
+        m_nodes.reserve(2 * cps.size() / BVH_LEAF_SEGMENTS + 1);
+        m_nodes.push_back(Node{});
+        build(0, 0, uint32_t(cps.size()), order, centroids, segments, 0);
+
+        // store the segments in leaf order so each leaf reads one contiguous run
+        m_segments.resize(segments.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            m_segments[i] = segments[order[i]];
+        }
+    }
+
+    template <class Basis>
+    void CurveBVH::toBezier(CurveControlPoints const &cps, size_t i, Segment &seg)
+    {
+        segmentBezier<Basis>(cps, i, seg.b);
+        seg.index = uint32_t(i);
+    }
+
+    template <class Basis>
+    void CurveBVH::refit(Curve<Basis> const &curve)
+    {
+        refitSegments(curve, 0, m_segments.size());
+        refitNodes(0, m_nodes.size());
+    }
+
+    template <class Basis>
+    void CurveBVH::refitSegments(Curve<Basis> const &curve, size_t begin, size_t end)
+    {
+        CurveControlPoints const &cps = curve.controlPoints();
+        assert(cps.size() == m_curve_size);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            toBezier<Basis>(cps, m_segments[i].index, m_segments[i]);
+        }
+    }
+
+    void CurveBVH::refitNodes(size_t begin, size_t end)
+    {
+        // children are always stored after their parent, so walking backwards sees them first
+        for (size_t k = begin; k < end; k++)
+        {
+            Node &node = m_nodes[m_nodes.size() - 1 - k];
+            if (node.count > 0)
+            {
+                node.lo = glm::vec3(std::numeric_limits<float>::infinity());
+                node.hi = glm::vec3(-std::numeric_limits<float>::infinity());
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    for (glm::vec3 const &b : m_segments[i].b)
+                    {
+                        node.lo = glm::min(node.lo, b);
+                        node.hi = glm::max(node.hi, b);
+                    }
+                }
+            }
+            else
+            {
+                node.lo = glm::min(m_nodes[node.first].lo, m_nodes[node.first + 1].lo);
+                node.hi = glm::max(m_nodes[node.first].hi, m_nodes[node.first + 1].hi);
+            }
+        }
+    }
+
+    void CurveBVH::build(uint32_t node, uint32_t first, uint32_t count, std::vector<uint32_t> &order,
+                         std::vector<glm::vec3> const &centroids, std::vector<Segment> const &segments, uint32_t depth)
+    {
+        // bounds of the segments and of their centres
+        glm::vec3 lo(std::numeric_limits<float>::infinity());
+        glm::vec3 hi(-std::numeric_limits<float>::infinity());
+        glm::vec3 c_lo = lo;
+        glm::vec3 c_hi = hi;
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            Segment const &seg = segments[order[i]];
+            for (glm::vec3 const &b : seg.b)
+            {
+                lo = glm::min(lo, b);
+                hi = glm::max(hi, b);
+            }
+            c_lo = glm::min(c_lo, centroids[order[i]]);
+            c_hi = glm::max(c_hi, centroids[order[i]]);
+        }
+        m_nodes[node].lo = lo;
+        m_nodes[node].hi = hi;
+
+        if (count <= BVH_LEAF_SEGMENTS || depth + 1 >= BVH_MAX_DEPTH)
+        {
+            m_nodes[node].first = first;
+            m_nodes[node].count = count;
+            return;
+        }
+
+        // median split along the widest spread of centres keeps the tree balanced (depth log2(n / leaf size))
+        glm::vec3 extent = c_hi - c_lo;
+        int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+        uint32_t half = count / 2;
+        std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                         [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        // the children sit next to each other so a node only stores the left one
+        uint32_t left = uint32_t(m_nodes.size());
+        m_nodes.push_back(Node{});
+        m_nodes.push_back(Node{});
+        m_nodes[node].first = left;
+        m_nodes[node].count = 0;
+
+        build(left, first, half, order, centroids, segments, depth + 1);
+        build(left + 1, first + half, count - half, order, centroids, segments, depth + 1);
+    }
+
+    size_t CurveBVH::size() const
+    {
+        return m_segments.size();
+    }
+
+    size_t CurveBVH::nodeCount() const
+    {
+        return m_nodes.size();
+    }
+
+    float CurveBVH::globalU(Segment const &seg, float u) const
+    {
+        float U = (float(seg.index) + u) / float(m_curve_size);
+        // u = 1 on the last segment is the start of the curve again
+        return U < 1.0f ? U : 0.0f;
+    }
+
+    CurvePoint CurveBVH::closestPoint(glm::vec3 p, ArcLengthTable const &table) const
+    {
+        CurvePoint result{0.0f, 0.0f, std::numeric_limits<float>::infinity(), glm::vec3(0.0f)};
+        if (m_nodes.empty())
+        {
+            return result;
+        }
+
+        float best_d2 = std::numeric_limits<float>::infinity();
+        Segment const *best_seg = nullptr;
+        float best_u = 0.0f;
+
+        uint32_t stack[BVH_MAX_DEPTH + 1];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            Node const &node = m_nodes[stack[--top]];
+            if (boxDistance2(node.lo, node.hi, p) >= best_d2)
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    glm::vec3 const *b = m_segments[i].b;
+                    float d2;
+                    float u = minimizeOnSegment(
+                        [&](float u) { glm::vec3 d = bezier(b, u) - p; return glm::dot(d, d); },
+                        [&](float u, float &d1, float &dd) {
+                            glm::vec3 d = bezier(b, u) - p;
+                            glm::vec3 db = bezierDerivative(b, u);
+                            d1 = glm::dot(d, db);
+                            dd = glm::dot(db, db) + glm::dot(d, bezierSecondDerivative(b, u));
+                        },
+                        d2);
+                    if (d2 < best_d2)
+                    {
+                        best_d2 = d2;
+                        best_seg = &m_segments[i];
+                        best_u = u;
+                    }
+                }
+                continue;
+            }
+
+            // visit the nearer child first (pushed last) so the bound tightens sooner
+            uint32_t near_child = node.first;
+            uint32_t far_child = node.first + 1;
+            if (boxDistance2(m_nodes[far_child].lo, m_nodes[far_child].hi, p) <
+                boxDistance2(m_nodes[near_child].lo, m_nodes[near_child].hi, p))
+            {
+                std::swap(near_child, far_child);
+            }
+            stack[top++] = far_child;
+            stack[top++] = near_child;
+        }
+
+        if (best_seg)
+        {
+            result.U = globalU(*best_seg, best_u);
+            result.s = table.sAt(result.U);
+            result.distance = std::sqrt(best_d2);
+            result.position = bezier(best_seg->b, best_u);
+        }
+        return result;
+    }
+
+    CurveRayHit CurveBVH::raycast(glm::vec3 origin, glm::vec3 direction, float radius, ArcLengthTable const &table) const
+    {
+        CurveRayHit result{false, 0.0f, 0.0f, std::numeric_limits<float>::infinity(), glm::vec3(0.0f)};
+        if (m_nodes.empty() || glm::dot(direction, direction) == 0.0f)
+        {
+            return result;
+        }
+
+        glm::vec3 d = glm::normalize(direction);
+        // division by a zero component gives infinity, which the slab test handles
+        glm::vec3 inv_dir = 1.0f / d;
+        float radius2 = radius * radius;
+
+        float best_t = std::numeric_limits<float>::infinity();
+        Segment const *best_seg = nullptr;
+        float best_u = 0.0f;
+
+        uint32_t stack[BVH_MAX_DEPTH + 1];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            Node const &node = m_nodes[stack[--top]];
+            if (boxEntry(node.lo, node.hi, radius, origin, inv_dir) >= best_t)
+            {
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    glm::vec3 const *b = m_segments[i].b;
+                    // the part of (point - origin) perpendicular to the ray
+                    auto perpendicular = [&](glm::vec3 v) { return v - glm::dot(v, d) * d; };
+                    float d2;
+                    float u = minimizeOnSegment(
+                        [&](float u) { glm::vec3 r = perpendicular(bezier(b, u) - origin); return glm::dot(r, r); },
+                        [&](float u, float &d1, float &dd) {
+                            glm::vec3 r = perpendicular(bezier(b, u) - origin);
+                            glm::vec3 dr = perpendicular(bezierDerivative(b, u));
+                            d1 = glm::dot(r, dr);
+                            dd = glm::dot(dr, dr) + glm::dot(r, perpendicular(bezierSecondDerivative(b, u)));
+                        },
+                        d2);
+                    if (d2 > radius2)
+                    {
+                        continue;
+                    }
+
+                    // step back from the closest approach to where the ray enters the radius
+                    float t = glm::dot(bezier(b, u) - origin, d) - std::sqrt(radius2 - d2);
+                    if (t >= 0.0f && t < best_t)
+                    {
+                        best_t = t;
+                        best_seg = &m_segments[i];
+                        best_u = u;
+                    }
+                }
+                continue;
+            }
+
+            uint32_t near_child = node.first;
+            uint32_t far_child = node.first + 1;
+            if (boxEntry(m_nodes[far_child].lo, m_nodes[far_child].hi, radius, origin, inv_dir) <
+                boxEntry(m_nodes[near_child].lo, m_nodes[near_child].hi, radius, origin, inv_dir))
+            {
+                std::swap(near_child, far_child);
+            }
+            stack[top++] = far_child;
+            stack[top++] = near_child;
+        }
+
+        if (best_seg)
+        {
+            result.hit = true;
+            result.U = globalU(*best_seg, best_u);
+            result.s = table.sAt(result.U);
+            result.t = best_t;
+            result.position = bezier(best_seg->b, best_u);
+        }
+        return result;
+    }
+
+    // the curve types of hermite_curve.hpp
+    template CurveBVH::CurveBVH(HermiteCurve const &);
+    template CurveBVH::CurveBVH(BSplineCurve const &);
+    template CurveBVH::CurveBVH(BezierCurve const &);
+    template void CurveBVH::refit(HermiteCurve const &);
+    template void CurveBVH::refit(BSplineCurve const &);
+    template void CurveBVH::refit(BezierCurve const &);
+    template void CurveBVH::refitSegments(HermiteCurve const &, size_t, size_t);
+    template void CurveBVH::refitSegments(BSplineCurve const &, size_t, size_t);
+    template void CurveBVH::refitSegments(BezierCurve const &, size_t, size_t);
+}
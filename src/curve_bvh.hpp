@@ -0,0 +1,123 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "hermite_curve.hpp"
+#include "arc_length_parameterize.hpp"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#define BVH_LEAF_SEGMENTS 4
+#define BVH_MAX_DEPTH 64
+#define BVH_SEGMENT_SAMPLES 8
+#define BVH_NEWTON_STEPS 4
+
+namespace modelling
+{
+    // the point on the curve closest to a query point
+    struct CurvePoint
+    {
+        float U;          // the global curve parameter
+        float s;          // the arc length position of U
+        float distance;   // from the query point, infinity when the curve is empty
+        glm::vec3 position;
+    };
+
+    // where a ray first passes within the pick radius of the curve
+    struct CurveRayHit
+    {
+        bool hit;
+        float U;
+        float s;
+        float t;          // the distance along the ray to where it enters the radius
+        glm::vec3 position; // the point on the curve
+    };
+
+    /**
+     * A bounding volume hierarchy over the segments of a curve in any basis (instantiated for the three in
+     * hermite_curve.hpp). Each segment is stored in its Bezier form, the box around its four control points bounds the segment
+     * (convex hull property). Queries walk the tree nearest box first and prune against the best result so far,
+     * then refine the parameter inside the candidate segments with a few samples and Newton steps.
+     */
+    class CurveBVH
+    {
+    public:
+        CurveBVH() = default;
+        template <class Basis>
+        explicit CurveBVH(Curve<Basis> const &curve);
+
+        /**
+         * update the boxes for moved control points without changing the tree (the curve must have the same size)
+         * the tree gets looser as points move far, rebuild it after large edits
+         */
+        template <class Basis>
+        void refit(Curve<Basis> const &curve);
+
+        /*
+         * refit in parts so it can be done a slice at a time: refitSegments over [0, size()),
+         * then refitNodes over [0, nodeCount()) with the slices in order
+         */
+        template <class Basis>
+        void refitSegments(Curve<Basis> const &curve, size_t begin, size_t end);
+        // the boxes of nodes [begin, end) counted from the last node back, so children are refit before their parent
+        void refitNodes(size_t begin, size_t end);
+
+        // the number of curve segments in the tree
+        size_t size() const;
+        // the number of nodes in the tree
+        size_t nodeCount() const;
+
+        /**
+         * find the closest point on the curve to p
+         * @param table the arc length table of the same curve, used to find s
+         */
+        CurvePoint closestPoint(glm::vec3 p, ArcLengthTable const &table) const;
+
+        /**
+         * find the first place a ray passes within radius of the curve
+         * @param direction does not have to be normalized
+         * @param table the arc length table of the same curve, used to find s
+         */
+        CurveRayHit raycast(glm::vec3 origin, glm::vec3 direction, float radius, ArcLengthTable const &table) const;
+
+    private:
+        struct Node
+        {
+            glm::vec3 lo;
+            glm::vec3 hi;
+            uint32_t first; // the left child (the right child follows it) or the first segment of a leaf
+            uint32_t count; // the number of segments in a leaf, zero for an interior node
+        };
+
+        // the Bezier control points of one segment and its index along the curve
+        struct Segment
+        {
+            glm::vec3 b[4];
+            uint32_t index;
+        };
+
+        std::vector<Node> m_nodes;
+        std::vector<Segment> m_segments; // in leaf order
+        size_t m_curve_size = 0;
+
+        /**
+         * fill in a node for segments [first, first + count) of order and split it until the leaves are small
+         * @param order the segment indices, partitioned in place
+         * @param centroids the box centre of every segment (by segment index)
+         */
+        void build(uint32_t node, uint32_t first, uint32_t count, std::vector<uint32_t> &order,
+                   std::vector<glm::vec3> const &centroids, std::vector<Segment> const &segments, uint32_t depth);
+
+        // the Bezier form of segment i of a curve
+        template <class Basis>
+        static void toBezier(CurveControlPoints const &cps, size_t i, Segment &seg);
+
+        // the global U for a local u in a segment
+        float globalU(Segment const &seg, float u) const;
+    };
+}
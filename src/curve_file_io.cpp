@@ -1,12 +1,39 @@
 #include "curve_file_io.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
 #include <cstddef>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iomanip>
 #include <iterator>
-#include <sstream>
-
-namespace modelling {
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// files at least this big are streamed in chunks instead of memory mapped
+#define STREAMING_THRESHOLD (32u << 20)
+#define STREAM_CHUNK_SIZE (1u << 20)
+#define STREAM_CHUNK_COUNT 3
+
+namespace modelling {
 	// HELPER FUNCTIONS because GLM does not provide them (should be in another
 	// place, but are acceptable in .cpp (local to this translation unit)
 	std::istream& operator>>(std::istream& in, glm::vec3& vec) {
@@ -33,6 +60,8 @@ namespace modelling {
 	void saveHermiteCurveToFile(const HermiteCurve& curve,
 		const std::string& filePath) {
 		std::ofstream file(filePath);
+		// enough digits that the floats read back exactly
+		file << std::setprecision(std::numeric_limits<float>::max_digits10);
 		for (auto const& cp : curve.controlPoints()) {
 			file << cp << '\n';
 		}
@@ -42,134 +71,458 @@ namespace modelling {
 	void saveHermiteCurveTo_OBJ_File(const HermiteCurve& curve,
 		const std::string& filePath) {
 		std::ofstream file(filePath);
+		// enough digits that the floats read back exactly
+		file << std::setprecision(std::numeric_limits<float>::max_digits10);
 		for (auto const& cp : curve.controlPoints()) {
-			file << cp.position << '\n';
+			file << "v " << cp.position << '\n';
 		}
 		file.close();
 	}
 
-	std::optional<HermiteCurve>
-		readHermiteCurveFromFile(std::string const& filePath) {
-		using std::istreambuf_iterator;
-		using std::string;
-		using std::stringstream;
+	static_assert(sizeof(HermiteCurve::ControlPoint) == 6 * sizeof(float),
+		"binary track files store control points as 6 packed floats");
+	static_assert(sizeof(BinaryCurveHeader) == 16, "binary track header must be packed");
 
-		HermiteCurve::ControlPoints cps;
-		std::ifstream file(filePath);
+	namespace {
+		bool isLittleEndianHost() {
+			uint32_t one = 1;
+			unsigned char first;
+			std::memcpy(&first, &one, 1);
+			return first == 1;
+		}
+
+		// reverses the bytes of count 4 byte words (uint32s or floats) in place
+		void swapWords(void* data, size_t count) {
+			unsigned char* bytes = static_cast<unsigned char*>(data);
+			for (size_t i = 0; i < count; i++, bytes += 4) {
+				std::swap(bytes[0], bytes[3]);
+				std::swap(bytes[1], bytes[2]);
+			}
+		}
+
+		// the header words after the magic, swapped between the file and a big endian host
+		void swapHeader(BinaryCurveHeader& header) {
+			swapWords(&header.version, 1);
+			swapWords(&header.flags, 1);
+			swapWords(&header.count, 1);
+		}
 
+		// true if the extension of filePath is ext, in any case
+		bool hasExtension(std::string const& filePath, std::string const& ext) {
+			if (filePath.size() < ext.size()) return false;
+			return std::equal(ext.begin(), ext.end(), filePath.end() - ext.size(), [](char a, char b) {
+				return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+			});
+		}
+	} // namespace
+
+	void saveHermiteCurveToBinaryFile(const HermiteCurve& curve,
+		const std::string& filePath) {
+		auto const& cps = curve.controlPoints();
+
+		BinaryCurveHeader header;
+		std::memcpy(header.magic, BinaryCurveHeader::MAGIC, sizeof(header.magic));
+		header.version = BinaryCurveHeader::VERSION;
+		header.flags = 0;
+		header.count = uint32_t(cps.size());
+
+		std::ofstream file(filePath, std::ios::binary);
+		size_t cpBytes = cps.size() * sizeof(HermiteCurve::ControlPoint);
+		if (isLittleEndianHost()) {
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(cps.data()), std::streamsize(cpBytes));
+		}
+		else {
+			swapHeader(header);
+			std::vector<HermiteCurve::ControlPoint> swapped(cps.begin(), cps.end());
+			swapWords(swapped.data(), swapped.size() * 6);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(swapped.data()), std::streamsize(cpBytes));
+		}
+		file.close();
+	}
+
+	std::optional<HermiteCurve>
+		readHermiteCurveFromBinaryFile(std::string const& filePath) {
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
 		if (!file) {
 			std::cerr << "Unable to open file " << filePath << '\n';
 			return std::nullopt;
 		}
+		size_t fileSize = size_t(file.tellg());
+		file.seekg(0);
+
+		BinaryCurveHeader header;
+		if (fileSize < sizeof(header) ||
+			!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+			std::memcmp(header.magic, BinaryCurveHeader::MAGIC, sizeof(header.magic)) != 0) {
+			std::cerr << "Not a binary track file " << filePath << '\n';
+			return std::nullopt;
+		}
+		bool swap = !isLittleEndianHost();
+		if (swap) swapHeader(header);
+		if (header.version != BinaryCurveHeader::VERSION) {
+			std::cerr << "Unsupported binary track version " << header.version
+				<< " in " << filePath << '\n';
+			return std::nullopt;
+		}
 
-		string line;
-		size_t index;
-		stringstream ss(std::ios_base::in);
-		size_t lineNum = 0;
+		// check the count against the file before allocating anything (older files may have segment lengths after the control points)
+		size_t cpBytes = size_t(header.count) * sizeof(HermiteCurve::ControlPoint);
+		size_t lengthBytes = (header.flags & BinaryCurveHeader::SEGMENT_LENGTHS) ? size_t(header.count) * sizeof(float) : 0;
+		if (fileSize - sizeof(header) < cpBytes + lengthBytes) {
+			std::cerr << "Truncated binary track file " << filePath << '\n';
+			return std::nullopt;
+		}
 
-		while (getline(file, line)) {
-			++lineNum;
+		HermiteCurve::ControlPoints cps(header.count);
+		if (!file.read(reinterpret_cast<char*>(cps.data()), std::streamsize(cpBytes))) {
+			std::cerr << "Error reading binary track file " << filePath << '\n';
+			return std::nullopt;
+		}
+		if (swap) swapWords(cps.data(), cps.size() * 6);
 
-			// remove comments
-			index = line.find_first_of("#");
-			if (index != string::npos) {
-				line.erase(index, string::npos);
-			}
+		return HermiteCurve(std::move(cps));
+	}
 
-			// removes leading/tailing junk
-			line.erase(0, line.find_first_not_of(" \t\r\n\v\f"));
-			index = line.find_last_not_of(" \t\r\n\v\f") + 1;
-			if (index != string::npos) {
-				line.erase(index, string::npos);
+	std::optional<HermiteCurve>
+		readHermiteCurveFromAnyFile(std::string const& filePath) {
+		if (hasExtension(filePath, ".hcb")) return readHermiteCurveFromBinaryFile(filePath);
+		if (hasExtension(filePath, ".txt")) return readHermiteCurveFromFile(filePath);
+		return readHermiteCurveFrom_OBJ_File(filePath);
+	}
+
+	void saveHermiteCurveToAnyFile(HermiteCurve const& curve,
+		std::string const& filePath) {
+		if (hasExtension(filePath, ".hcb")) saveHermiteCurveToBinaryFile(curve, filePath);
+		else if (hasExtension(filePath, ".txt")) saveHermiteCurveToFile(curve, filePath);
+		else saveHermiteCurveTo_OBJ_File(curve, filePath);
+	}
+
+	namespace {
+		// read only view of a whole file, memory mapped where the platform allows it
+		class MappedFile {
+		public:
+			explicit MappedFile(std::string const& filePath) {
+#ifdef _WIN32
+				std::ifstream file(filePath, std::ios::binary);
+				if (!file) return;
+				m_buffer.assign(std::istreambuf_iterator<char>(file),
+					std::istreambuf_iterator<char>());
+				m_data = m_buffer.data();
+				m_size = m_buffer.size();
+				m_open = true;
+#else
+				int fd = ::open(filePath.c_str(), O_RDONLY);
+				if (fd < 0) return;
+				struct stat st;
+				if (::fstat(fd, &st) == 0) {
+					m_open = true;
+					m_size = size_t(st.st_size);
+					if (m_size > 0) {
+						void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+						if (p == MAP_FAILED) {
+							m_open = false;
+							m_size = 0;
+						}
+						else {
+							::madvise(p, m_size, MADV_SEQUENTIAL);
+							m_data = static_cast<const char*>(p);
+						}
+					}
+				}
+				::close(fd);
+#endif
 			}
 
-			if (line.empty()) {
-				continue; // empty or commented out line
+			~MappedFile() {
+#ifndef _WIN32
+				if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
 			}
 
-			ss.str(line);
-			ss.clear();
+			MappedFile(MappedFile const&) = delete;
+			MappedFile& operator=(MappedFile const&) = delete;
 
-			HermiteCurve::ControlPoint cp;
-			ss >> cp;
+			bool isOpen() const { return m_open; }
+			const char* begin() const { return m_data; }
+			const char* end() const { return m_data + m_size; }
 
-			if (!ss) {
-				std::cerr << "Error read file: " + line +
-					" (line: " + std::to_string(lineNum) + ")";
-			}
-			else {
-				cps.push_back(cp);
+		private:
+			const char* m_data = nullptr;
+			size_t m_size = 0;
+			bool m_open = false;
+#ifdef _WIN32
+			std::string m_buffer;
+#endif
+		};
+
+		bool isSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+		}
+
+		// parses count whitespace separated floats starting at p, moves p past them
+		bool parseFloats(const char*& p, const char* end, float* out, int count) {
+			for (int i = 0; i < count; i++) {
+				while (p < end && isSpace(*p)) ++p;
+				// from_chars does not take a leading '+' (operator>> did)
+				if (p < end && *p == '+') ++p;
+				auto [next, ec] = std::from_chars(p, end, out[i]);
+				if (ec != std::errc() || next == p) return false;
+				p = next;
 			}
+			return true;
 		}
-		file.close();
 
-		return HermiteCurve(cps);
-	}
+		/**
+		 * Reads a file in fixed size chunks on a prefetch thread so reading the next chunk overlaps
+		 * parsing the current one. At most STREAM_CHUNK_COUNT chunks are held at once, so memory
+		 * use does not depend on the size of the file.
+		 */
+		class ChunkStream {
+		public:
+			struct Chunk {
+				std::unique_ptr<char[]> data;
+				size_t size = 0;
+			};
+
+			explicit ChunkStream(std::string const& filePath)
+				: m_file(filePath, std::ios::binary) {
+				if (!m_file) return;
+				for (Chunk& chunk : m_chunks) {
+					chunk.data = std::make_unique<char[]>(STREAM_CHUNK_SIZE);
+					m_free.push_back(&chunk);
+				}
+				m_thread = std::thread(&ChunkStream::prefetch, this);
+			}
 
-	std::optional<HermiteCurve>
-		readHermiteCurveFrom_OBJ_File(std::string const& filePath) {
-		using std::istreambuf_iterator;
-		using std::string;
-		using std::stringstream;
+			~ChunkStream() {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_cv.notify_all();
+				if (m_thread.joinable()) m_thread.join();
+			}
 
-		HermiteCurve::ControlPoints cps;
-		std::ifstream objFile(filePath);
+			ChunkStream(ChunkStream const&) = delete;
+			ChunkStream& operator=(ChunkStream const&) = delete;
+
+			bool isOpen() const { return m_thread.joinable(); }
+
+			// hands back the previous chunk and waits for the next one, nullptr at the end of the file
+			Chunk const* next() {
+				std::unique_lock<std::mutex> lock(m_mutex);
+				if (m_current) {
+					m_free.push_back(m_current);
+					m_current = nullptr;
+					m_cv.notify_all();
+				}
+				m_cv.wait(lock, [this] { return !m_filled.empty() || m_done; });
+				if (m_filled.empty()) return nullptr;
+				m_current = m_filled.front();
+				m_filled.pop_front();
+				return m_current;
+			}
 
-		if (!objFile) {
-			std::cerr << "Unable to open file " << filePath << '\n';
-			return std::nullopt;
+		private:
+			std::ifstream m_file;
+			std::array<Chunk, STREAM_CHUNK_COUNT> m_chunks;
+			std::deque<Chunk*> m_free;
+			std::deque<Chunk*> m_filled;
+			Chunk* m_current = nullptr;
+			bool m_done = false;
+			bool m_stop = false;
+			std::mutex m_mutex;
+			std::condition_variable m_cv;
+			std::thread m_thread;
+
+			void prefetch() {
+				while (true) {
+					Chunk* chunk;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_cv.wait(lock, [this] { return !m_free.empty() || m_stop; });
+						if (m_stop) break;
+						chunk = m_free.front();
+						m_free.pop_front();
+					}
+
+					// read outside the lock so the parser keeps going
+					m_file.read(chunk->data.get(), STREAM_CHUNK_SIZE);
+					chunk->size = size_t(m_file.gcount());
+
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (chunk->size > 0) m_filled.push_back(chunk);
+					if (chunk->size < STREAM_CHUNK_SIZE) break;
+					m_cv.notify_all();
+				}
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_done = true;
+				m_cv.notify_all();
+			}
+		};
+
+		/**
+		 * calls parseLine(begin, end, lineNum) for every line in [begin, end) that is not empty once
+		 * comments and leading/tailing junk are removed, lineNum carries on from the previous call
+		 */
+		template <typename ParseLine>
+		void parseLines(const char* p, const char* end, size_t& lineNum, ParseLine& parseLine) {
+			while (p < end) {
+				++lineNum;
+				const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+				if (!lineEnd) lineEnd = end;
+				const char* next = lineEnd < end ? lineEnd + 1 : end;
+
+				// remove comments
+				const char* comment = static_cast<const char*>(std::memchr(p, '#', lineEnd - p));
+				if (comment) lineEnd = comment;
+
+				// removes leading/tailing junk
+				while (p < lineEnd && isSpace(*p)) ++p;
+				while (lineEnd > p && isSpace(lineEnd[-1])) --lineEnd;
+
+				if (p != lineEnd) parseLine(p, lineEnd, lineNum);
+				p = next;
+			}
 		}
 
-		string line;
-		size_t index;
-		stringstream ss(std::ios_base::in);
-		size_t lineNum = 0;
+		// the expected number of lines in a file of fileSize bytes that starts with [begin, end)
+		size_t estimateLines(const char* begin, const char* end, size_t fileSize) {
+			if (begin == end) return 0;
+			size_t lines = size_t(std::count(begin, end, '\n')) + 1;
+			double perByte = double(lines) / double(end - begin);
+			// a little slack so a slightly denser tail does not trigger a full reallocation
+			return size_t(perByte * double(fileSize) * 1.0625) + 1;
+		}
 
-		while (getline(objFile, line)) {
-			++lineNum;
+		/**
+		 * runs parseLine over every line of the file, reserving cps up front from the line density.
+		 * Small files are memory mapped, large ones are streamed in chunks.
+		 * @return false if the file could not be opened
+		 */
+		template <typename ParseLine>
+		bool readLines(std::string const& filePath, HermiteCurve::ControlPoints& cps, ParseLine parseLine) {
+			std::error_code error;
+			size_t fileSize = size_t(std::filesystem::file_size(filePath, error));
+			if (error) return false;
+
+			size_t lineNum = 0;
+			if (fileSize < STREAMING_THRESHOLD) {
+				MappedFile file(filePath);
+				if (!file.isOpen()) return false;
+				cps.reserve(estimateLines(file.begin(), file.end(), fileSize));
+				parseLines(file.begin(), file.end(), lineNum, parseLine);
+				return true;
+			}
 
-			// remove comments
-			index = line.find_first_of("#");
-			if (index != string::npos) {
-				line.erase(index, string::npos);
+			ChunkStream stream(filePath);
+			if (!stream.isOpen()) return false;
+
+			// the partial line at the end of a chunk waits here for the rest of it
+			std::string carry;
+			bool first = true;
+			while (ChunkStream::Chunk const* chunk = stream.next()) {
+				const char* begin = chunk->data.get();
+				const char* end = begin + chunk->size;
+				if (first) {
+					cps.reserve(estimateLines(begin, end, fileSize));
+					first = false;
+				}
+
+				const char* firstNewline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+				if (!firstNewline) {
+					carry.append(begin, end);
+					continue;
+				}
+
+				// finish the line started in the previous chunk
+				if (!carry.empty()) {
+					carry.append(begin, firstNewline + 1);
+					parseLines(carry.data(), carry.data() + carry.size(), lineNum, parseLine);
+					carry.clear();
+					begin = firstNewline + 1;
+				}
+
+				const char* lastNewline = end;
+				while (lastNewline[-1] != '\n') --lastNewline;
+				parseLines(begin, lastNewline, lineNum, parseLine);
+				carry.assign(lastNewline, end);
 			}
+			parseLines(carry.data(), carry.data() + carry.size(), lineNum, parseLine);
+			return true;
+		}
+
+		void reportError(const char* begin, const char* end, size_t lineNum) {
+			std::cerr << "Error read file: " + std::string(begin, end) +
+				" (line: " + std::to_string(lineNum) + ")";
+		}
 
-			// removes leading/tailing junk
-			line.erase(0, line.find_first_not_of(" \t\r\n\v\f"));
-			index = line.find_last_not_of(" \t\r\n\v\f") + 1;
-			if (index != string::npos) {
-				line.erase(index, string::npos);
+		// "px py pz tx ty tz"
+		void parseControlPointLine(const char* begin, const char* end, size_t lineNum,
+			HermiteCurve::ControlPoints& cps) {
+			float values[6];
+			const char* p = begin;
+			if (!parseFloats(p, end, values, 6)) {
+				reportError(begin, end, lineNum);
+				return;
 			}
+			HermiteCurve::ControlPoint cp;
+			cp.position = glm::vec3(values[0], values[1], values[2]);
+			cp.tangent = glm::vec3(values[3], values[4], values[5]);
+			cps.push_back(cp);
+		}
 
-			if (line.empty()) {
-				continue; // empty or commented out line
+		// "v px py pz", other OBJ lines are skipped
+		void parseVertexLine(const char* begin, const char* end, size_t lineNum,
+			HermiteCurve::ControlPoints& cps) {
+			if (*begin != 'v') // only accept vertices (control points)
+				return;
+
+			float values[3];
+			const char* p = begin + 1;
+			if (!parseFloats(p, end, values, 3)) {
+				reportError(begin, end, lineNum);
+				return;
 			}
+			HermiteCurve::ControlPoint cp;
+			cp.position = glm::vec3(values[0], values[1], values[2]);
+			cps.push_back(cp);
+		}
+	} // namespace
 
-			if (line.front() != 'v') // only accept vertices (control points)
-				continue;
+	std::optional<HermiteCurve>
+		readHermiteCurveFromFile(std::string const& filePath) {
+		HermiteCurve::ControlPoints cps;
+		bool opened = readLines(filePath, cps, [&cps](const char* begin, const char* end, size_t lineNum) {
+			parseControlPointLine(begin, end, lineNum, cps);
+		});
 
-			ss.str(line);
-			ss.clear();
+		if (!opened) {
+			std::cerr << "Unable to open file " << filePath << '\n';
+			return std::nullopt;
+		}
 
-			char isV; // stupid but meh
-			ss >> isV;
+		return HermiteCurve(std::move(cps));
+	}
 
-			HermiteCurve::ControlPoint cp;
-			ss >> cp.position;
+	std::optional<HermiteCurve>
+		readHermiteCurveFrom_OBJ_File(std::string const& filePath) {
+		HermiteCurve::ControlPoints cps;
+		bool opened = readLines(filePath, cps, [&cps](const char* begin, const char* end, size_t lineNum) {
+			parseVertexLine(begin, end, lineNum, cps);
+		});
 
-			if (!ss) {
-				std::cerr << "Error read file: " + line +
-					" (line: " + std::to_string(lineNum) + ")";
-			}
-			else {
-				cps.push_back(cp);
-			}
+		if (!opened) {
+			std::cerr << "Unable to open file " << filePath << '\n';
+			return std::nullopt;
 		}
-		objFile.close();
 
 		// set tangets
 		HermiteCurve::calculateCatmullRomTangents(cps);
 
-		return HermiteCurve(cps);
-	}
+		return HermiteCurve(std::move(cps));
+	}
 } // namespace modelling
\ No newline at end of file
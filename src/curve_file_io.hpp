@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -19,4 +20,36 @@ readHermiteCurveFromFile(std::string const &filePath);
 std::optional<HermiteCurve>
 readHermiteCurveFrom_OBJ_File(std::string const &filePath);
 
+// Binary track files (.hcb) start with this header, followed by count packed
+// control points (position then tangent, 6 floats). Every word of the file is
+// little endian, big endian hosts swap the bytes when reading and writing.
+// Files written with the SEGMENT_LENGTHS flag carry count more floats after
+// the control points, the reader skips them.
+struct BinaryCurveHeader {
+	static constexpr char MAGIC[4] = {'H', 'C', 'R', 'V'};
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t SEGMENT_LENGTHS = 1u << 0;
+
+	char magic[4];
+	uint32_t version;
+	uint32_t flags;
+	uint32_t count;
+};
+
+void saveHermiteCurveToBinaryFile(HermiteCurve const &curve,
+                                  std::string const &filePath);
+
+std::optional<HermiteCurve>
+readHermiteCurveFromBinaryFile(std::string const &filePath);
+
+// picks the reader from the extension, ignoring case (.hcb binary, .txt the
+// text format, anything else OBJ vertices like the original loader)
+std::optional<HermiteCurve>
+readHermiteCurveFromAnyFile(std::string const &filePath);
+
+// picks the writer from the extension like readHermiteCurveFromAnyFile (OBJ
+// keeps only the positions, the reader gives them Catmull-Rom tangents again)
+void saveHermiteCurveToAnyFile(HermiteCurve const &curve,
+                               std::string const &filePath);
+
 } // namespace modelling
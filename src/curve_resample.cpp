@@ -0,0 +1,155 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "curve_resample.hpp"
+#include "RollerCoaster.hpp"
+#include "arc_length_parameterize.hpp"
+#include "curve_bvh.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace modelling
+{
+    namespace
+    {
+        // the u step RollerCoaster::TableDeltaU would use for this curve
+        template <class CurveT>
+        float tableDeltaU(CurveT const &curve, float delta_s)
+        {
+            return (SAMPLING_FACTOR * delta_s) / (float(curve.size()) * curve.maxSeperation());
+        }
+
+        // a curve and what it takes to measure distances to it
+        template <class CurveT>
+        struct Measured
+        {
+            CurveT curve;
+            ArcLengthTable table;
+            CurveBVH bvh;
+
+            Measured(CurveT _curve, float delta_s)
+                : curve(std::move(_curve)), table(calculateArcLengthTable(curve, delta_s, tableDeltaU(curve, delta_s))), bvh(curve)
+            {
+            }
+        };
+
+        // the largest distance from samples evenly spaced in s along from to the curve to
+        template <class CurveT>
+        float oneSidedError(Measured<CurveT> const &from, Measured<CurveT> const &to, size_t samples, tasks::TaskScheduler *scheduler)
+        {
+            float ds = from.table.arc_length / float(samples);
+            std::vector<float> errors(samples);
+            auto measure = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    glm::vec3 p = from.curve(from.table(float(i) * ds));
+                    errors[i] = to.bvh.closestPoint(p, to.table).distance;
+                }
+            };
+            if (scheduler)
+            {
+                scheduler->parallel_for(0, samples, PARALLEL_GRAIN, measure);
+            }
+            else
+            {
+                measure(0, samples);
+            }
+            return *std::max_element(errors.begin(), errors.end());
+        }
+
+        // the control points n even arc length steps apart along a curve
+        template <class CurveT>
+        CurveT evenPoints(Measured<CurveT> const &source, size_t n)
+        {
+            typename CurveT::ControlPoints cps(n);
+            float ds = source.table.arc_length / float(n);
+            for (size_t k = 0; k < n; k++)
+            {
+                cps[k].position = source.curve(source.table(float(k) * ds));
+            }
+            CurveT::calculateCatmullRomTangents(cps);
+            return CurveT(std::move(cps));
+        }
+    }
+
+    template <class CurveT>
+    CurveT resampleUniform(CurveT const &curve, float tolerance, ResampleReport *report, tasks::TaskScheduler *scheduler)
+    {
+        PROFILE_SCOPE("resample curve");
+        auto start = std::chrono::steady_clock::now();
+        assert(curve.size() > 1);
+        assert(tolerance > 0.0f);
+
+        Measured<CurveT> source(curve, RESAMPLE_DELTA_S);
+        float length = source.table.arc_length;
+
+        // the refit with n points and its error, the tables only need to be fine enough to pick sample points
+        auto fit = [&](size_t n, float &error) {
+            float spacing = length / float(n);
+            Measured<CurveT> refit(evenPoints(source, n), spacing);
+            size_t samples = n * RESAMPLE_ERROR_SAMPLES;
+            error = std::max(oneSidedError(source, refit, samples, scheduler), oneSidedError(refit, source, samples, scheduler));
+            return refit;
+        };
+
+        // double until the error is within tolerance, n / 2 was not (or was too few points to try)
+        size_t n = RESAMPLE_MIN_POINTS;
+        float error = 0.0f;
+        Measured<CurveT> best = fit(n, error);
+        float best_error = error;
+        while (best_error > tolerance && n < RESAMPLE_MAX_POINTS)
+        {
+            n *= 2;
+            best = fit(n, error);
+            best_error = error;
+        }
+
+        // bisect for the fewest points, keeping the smallest fit that was measured to be within tolerance
+        if (best_error <= tolerance)
+        {
+            size_t lo = n / 2;
+            size_t hi = n;
+            while (hi - lo > 1 && lo >= RESAMPLE_MIN_POINTS)
+            {
+                size_t mid = lo + (hi - lo) / 2;
+                Measured<CurveT> candidate = fit(mid, error);
+                if (error <= tolerance)
+                {
+                    hi = mid;
+                    best = std::move(candidate);
+                    best_error = error;
+                }
+                else
+                {
+                    lo = mid;
+                }
+            }
+        }
+
+        if (report)
+        {
+            CurveT const &after = best.curve;
+            report->points_before = curve.size();
+            report->points_after = after.size();
+            report->spacing_ratio_before = curve.maxSeperation() / curve.minSeperation();
+            report->spacing_ratio_after = after.maxSeperation() / after.minSeperation();
+            report->step_factor_before = float(curve.size()) * curve.maxSeperation() / length;
+            report->step_factor_after = float(after.size()) * after.maxSeperation() / best.table.arc_length;
+            report->length_before = length;
+            report->length_after = best.table.arc_length;
+            report->max_error = best_error;
+            report->ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        return std::move(best.curve);
+    }
+
+    // the curve types of hermite_curve.hpp
+    template HermiteCurve resampleUniform(HermiteCurve const &, float, ResampleReport *, tasks::TaskScheduler *);
+    template BSplineCurve resampleUniform(BSplineCurve const &, float, ResampleReport *, tasks::TaskScheduler *);
+    template BezierCurve resampleUniform(BezierCurve const &, float, ResampleReport *, tasks::TaskScheduler *);
+}
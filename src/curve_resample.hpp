@@ -0,0 +1,58 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "hermite_curve.hpp"
+#include "task_scheduler.hpp"
+#include <cstddef>
+
+// the default largest distance (world units) the resampled curve may stray from the original
+#define RESAMPLE_TOLERANCE 0.01f
+// the arc length table spacing used to place the new control points on the original curve
+#define RESAMPLE_DELTA_S 0.1f
+// points compared per new segment (in both directions) when measuring the error
+#define RESAMPLE_ERROR_SAMPLES 16
+#define RESAMPLE_MIN_POINTS 4
+// the search for the point count gives up past this many points
+#define RESAMPLE_MAX_POINTS (1u << 20)
+
+namespace modelling
+{
+    struct ResampleReport
+    {
+        size_t points_before = 0;
+        size_t points_after = 0;
+        // the longest gap between neighbouring control points over the shortest
+        float spacing_ratio_before = 0.0f;
+        float spacing_ratio_after = 0.0f;
+        /*
+         * the arc length table walk takes n * max separation / length times the u steps a curve with perfectly
+         * even control points would (see RollerCoaster::TableDeltaU)
+         */
+        float step_factor_before = 0.0f;
+        float step_factor_after = 0.0f;
+        float length_before = 0.0f;
+        float length_after = 0.0f;
+        // the largest distance between the two curves in either direction, compare with the tolerance
+        float max_error = 0.0f;
+        float ms = 0.0f;
+    };
+
+    /**
+     * Refit a closed curve with control points at even arc length spacing. The new points are put at s = k L / n on
+     * the original curve and given Catmull-Rom tangents (what the OBJ reader gives them back), so with even spacing
+     * the speed |dC/du| is nearly constant and U is nearly proportional to s. The error is the larger of the two
+     * one sided distances, RESAMPLE_ERROR_SAMPLES points per segment of each curve measured against the other with
+     * its BVH. The point count doubles from RESAMPLE_MIN_POINTS until the error is within tolerance, then a bisection
+     * finds the fewest points that were measured to be within it.
+     * @param report filled in if not null, max_error is above tolerance if RESAMPLE_MAX_POINTS was not enough
+     * @param scheduler measures the error in parallel, null to measure it on the calling thread
+     */
+    template <class CurveT>
+    CurveT resampleUniform(CurveT const &curve, float tolerance = RESAMPLE_TOLERANCE, ResampleReport *report = nullptr,
+                           tasks::TaskScheduler *scheduler = nullptr);
+}
@@ -0,0 +1,31 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "frame_arena.hpp"
+
+namespace memory
+{
+    FrameArena::FrameArena(size_t bytes)
+        : m_block(new std::byte[bytes]), m_resource(m_block.get(), bytes, std::pmr::new_delete_resource())
+    {
+    }
+
+    std::pmr::memory_resource *FrameArena::resource()
+    {
+        return &m_resource;
+    }
+
+    void FrameArena::reset()
+    {
+        m_resource.release();
+    }
+
+    std::pmr::memory_resource *rebuildResource()
+    {
+        static std::pmr::synchronized_pool_resource pool;
+        return &pool;
+    }
+}
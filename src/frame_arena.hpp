@@ -0,0 +1,49 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace memory
+{
+    /**
+     * A fixed block of scratch memory handed out by bumping a pointer, everything is released at once by reset().
+     * Used for per-frame scratch containers so the frame loop does not touch the heap.
+     * If a frame needs more than the block it falls back to the heap (and shows up in the allocation counter).
+     */
+    class FrameArena
+    {
+    public:
+        /**
+         * @param bytes the size of the scratch block
+         */
+        explicit FrameArena(size_t bytes);
+
+        // the arena owns its block so it can not be copied or moved
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        // the memory resource to construct std::pmr containers with
+        std::pmr::memory_resource *resource();
+
+        // release everything allocated since the last reset, containers using the arena must be gone by now
+        void reset();
+
+    private:
+        std::unique_ptr<std::byte[]> m_block;
+        std::pmr::monotonic_buffer_resource m_resource;
+    };
+
+    /**
+     * The memory resource used for the containers that are rebuilt when the track changes
+     * (track pieces, supports, trees, frames). It is a thread safe pool, so blocks freed by one rebuild are reused
+     * by the next instead of going back to the heap.
+     */
+    std::pmr::memory_resource *rebuildResource();
+}
@@ -0,0 +1,227 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "frame_cache.hpp"
+#include <cassert>
+#include <cmath>
+
+namespace modelling
+{
+    FrameCache::FrameCache(float _length, size_t _n)
+    {
+        assert(_length > 0.0f && _n > 0);
+        m_length = _length;
+        m_delta_s = _length / float(_n);
+        reserve_memory(_n);
+    }
+
+    size_t FrameCache::size() const { return m_frames.size(); }
+
+    float FrameCache::deltaS() const { return m_delta_s; }
+
+    float FrameCache::length() const { return m_length; }
+
+    void FrameCache::addNext(glm::vec3 position, glm::quat frame, float bank)
+    {
+        m_positions.push_back(position);
+        m_frames.push_back(frame);
+        m_bank.push_back(bank);
+    }
+
+    void FrameCache::reserve_memory(size_t n)
+    {
+        m_positions.reserve(n);
+        m_frames.reserve(n);
+        m_bank.reserve(n);
+    }
+
+    FrameCache::Frame FrameCache::operator()(float s) const
+    {
+        size_t index_a, index_b;
+        float t;
+        locate(s, index_a, index_b, t);
+
+        // neighbouring frames are close together so nlerp is as good as slerp here and much cheaper
+        glm::quat q_a = m_frames[index_a];
+        glm::quat q_b = m_frames[index_b];
+        if (glm::dot(q_a, q_b) < 0.0f)
+        {
+            q_b = -q_b;
+        }
+        glm::quat q = glm::normalize(q_a * (1.0f - t) + q_b * t);
+
+        // twist the rotation minimizing frame around its tangent (local z axis)
+        float bank = bankBetween(index_a, index_b, t);
+        Frame frame;
+        frame.position = glm::mix(m_positions[index_a], m_positions[index_b], t);
+        frame.orientation = q * glm::angleAxis(bank, glm::vec3(0.0f, 0.0f, 1.0f));
+        return frame;
+    }
+
+    glm::vec3 FrameCache::position(float s) const
+    {
+        size_t index_a, index_b;
+        float t;
+        locate(s, index_a, index_b, t);
+        return glm::mix(m_positions[index_a], m_positions[index_b], t);
+    }
+
+    glm::quat FrameCache::orientation(float s) const
+    {
+        // twist the rotation minimizing frame around its tangent (local z axis)
+        return rotationMinimizingFrame(s) * glm::angleAxis(bankAt(s), glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    glm::quat FrameCache::rotationMinimizingFrame(float s) const
+    {
+        size_t index_a, index_b;
+        float t;
+        locate(s, index_a, index_b, t);
+        return glm::slerp(m_frames[index_a], m_frames[index_b], t);
+    }
+
+    float FrameCache::bankAt(float s) const
+    {
+        size_t index_a, index_b;
+        float t;
+        locate(s, index_a, index_b, t);
+        return bankBetween(index_a, index_b, t);
+    }
+
+    std::pmr::vector<glm::vec3> const &FrameCache::gridPositions() const { return m_positions; }
+
+    std::pmr::vector<glm::quat> const &FrameCache::gridFrames() const { return m_frames; }
+
+    std::pmr::vector<float> const &FrameCache::gridBanks() const { return m_bank; }
+
+    void FrameCache::packTexels(std::vector<glm::vec4> &texels) const
+    {
+        texels.resize(2 * m_positions.size());
+        for (size_t i = 0; i < m_positions.size(); i++)
+        {
+            glm::quat const &q = m_frames[i];
+            texels[2 * i] = glm::vec4(m_positions[i], m_bank[i]);
+            texels[2 * i + 1] = glm::vec4(q.x, q.y, q.z, q.w);
+        }
+    }
+
+    float FrameCache::bankBetween(size_t index_a, size_t index_b, float t) const
+    {
+        // take the short way around so the twist does not spin when the angle crosses +-pi
+        float d = std::remainder(m_bank[index_b] - m_bank[index_a], 2.0f * float(M_PI));
+        return m_bank[index_a] + d * t;
+    }
+
+    void FrameCache::locate(float s, size_t &index_a, size_t &index_b, float &t) const
+    {
+        assert(m_frames.size() > 0);
+
+        // wrap s value to ensure s in [0, length)
+        s = std::fmod(s, m_length);
+        if (s < 0)
+        {
+            s = s + m_length;
+        }
+
+        float x = s / m_delta_s;
+        index_a = size_t(std::floor(x));
+        t = x - float(index_a);
+        // the grid wraps exactly so the last interval ends on the first frame
+        index_a = index_a % m_frames.size();
+        index_b = (index_a + 1) % m_frames.size();
+    }
+
+    std::pmr::vector<glm::quat> calculateRotationMinimizingFrames(
+        std::pmr::vector<glm::vec3> const &points, std::pmr::vector<glm::vec3> const &tangents, glm::vec3 up)
+    {
+        assert(points.size() == tangents.size());
+        size_t n = points.size();
+        std::pmr::vector<glm::quat> frames(n, points.get_allocator().resource());
+        if (n == 0)
+        {
+            return frames;
+        }
+
+        glm::vec3 first = firstFrameNormal(tangents[0], up);
+        glm::vec3 normal = first;
+        propagateFrames(points, tangents, frames, 0, n, normal);
+        distributeClosingTwist(frames, closingTwist(normal, first, tangents[0]), 0, n);
+        return frames;
+    }
+
+    glm::vec3 firstFrameNormal(glm::vec3 const &tangent, glm::vec3 up)
+    {
+        glm::vec3 r = up - glm::dot(up, tangent) * tangent;
+        if (glm::length(r) < 1e-6f)
+        {
+            glm::vec3 axis = std::abs(tangent.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            r = glm::cross(tangent, axis);
+        }
+        return glm::normalize(r);
+    }
+
+    void propagateFrames(std::pmr::vector<glm::vec3> const &points, std::pmr::vector<glm::vec3> const &tangents,
+                         std::pmr::vector<glm::quat> &frames, size_t begin, size_t end, glm::vec3 &normal)
+    {
+        assert(points.size() == tangents.size() && frames.size() == points.size());
+        size_t n = points.size();
+        glm::vec3 r_i = normal;
+        for (size_t i = begin; i < end; i++)
+        {
+            size_t j = (i + 1) % n;
+            glm::vec3 t_i = tangents[i];
+            glm::vec3 B = glm::cross(r_i, t_i);
+            frames[i] = glm::quat_cast(glm::mat3(B, r_i, t_i));
+
+            // reflect across the plane bisecting the two points
+            glm::vec3 v1 = points[j] - points[i];
+            float c1 = glm::dot(v1, v1);
+            glm::vec3 r_L = r_i;
+            glm::vec3 t_L = t_i;
+            if (c1 > 1e-12f)
+            {
+                r_L = r_i - (2.0f / c1) * glm::dot(v1, r_i) * v1;
+                t_L = t_i - (2.0f / c1) * glm::dot(v1, t_i) * v1;
+            }
+
+            // reflect again so the reflected tangent lines up with the next tangent
+            glm::vec3 v2 = tangents[j] - t_L;
+            float c2 = glm::dot(v2, v2);
+            glm::vec3 r_next = r_L;
+            if (c2 > 1e-12f)
+            {
+                r_next = r_L - (2.0f / c2) * glm::dot(v2, r_L) * v2;
+            }
+
+            // keep the frame orthonormal so float error does not build up along the track
+            r_i = glm::normalize(r_next - glm::dot(r_next, tangents[j]) * tangents[j]);
+        }
+        normal = r_i;
+    }
+
+    float closingTwist(glm::vec3 const &end_normal, glm::vec3 const &first_normal, glm::vec3 const &first_tangent)
+    {
+        return std::atan2(glm::dot(glm::cross(end_normal, first_normal), first_tangent), glm::dot(end_normal, first_normal));
+    }
+
+    void distributeClosingTwist(std::pmr::vector<glm::quat> &frames, float closing, size_t begin, size_t end)
+    {
+        float n = float(frames.size());
+        for (size_t i = begin; i < end; i++)
+        {
+            float twist = closing * float(i) / n;
+            frames[i] = glm::normalize(frames[i] * glm::angleAxis(twist, glm::vec3(0.0f, 0.0f, 1.0f)));
+        }
+    }
+
+    float bankAngle(glm::quat const &frame, glm::vec3 a)
+    {
+        glm::vec3 B = frame * glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 N = frame * glm::vec3(0.0f, 1.0f, 0.0f);
+        // a twist of theta around the tangent moves the normal to cos(theta) N - sin(theta) B
+        return std::atan2(-glm::dot(a, B), glm::dot(a, N));
+    }
+}
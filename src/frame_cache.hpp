@@ -0,0 +1,132 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <memory_resource>
+#include <vector>
+#include "frame_arena.hpp"
+
+namespace modelling
+{
+    /**
+     * Precomputed positions and rotation minimizing frames along the track, stored on a uniform s grid.
+     * The frame columns are (B, N, T) so the local z axis is the tangent and the local y axis is the normal.
+     * The banking angle from the g-force model is stored along side and applied as a twist around the tangent.
+     * Carts, track pieces and supports all query this so the curve is only evaluated once per grid point.
+     */
+    class FrameCache
+    {
+    public:
+        // a position and banked orientation on the track
+        struct Frame
+        {
+            glm::vec3 position;
+            glm::quat orientation;
+        };
+
+        FrameCache() = default;
+
+        /**
+         * create an empty cache
+         * @param _length the arc length of the curve
+         * @param _n the number of grid points, the grid spacing is _length / _n so the grid wraps exactly
+         */
+        FrameCache(float _length, size_t _n);
+
+        size_t size() const;
+        float deltaS() const;
+        float length() const;
+
+        void addNext(glm::vec3 position, glm::quat frame, float bank);
+        void reserve_memory(size_t n);
+
+        /**
+         * get the position and banked orientation at s (lerp and nlerp between grid points)
+         */
+        Frame operator()(float s) const;
+
+        /**
+         * get the position at s (lerp between grid points)
+         */
+        glm::vec3 position(float s) const;
+
+        /**
+         * get the banked orientation at s (slerp between grid points)
+         */
+        glm::quat orientation(float s) const;
+
+        /**
+         * get the rotation minimizing frame at s without the banking twist
+         */
+        glm::quat rotationMinimizingFrame(float s) const;
+
+        /**
+         * get the banking angle (radians around the tangent) at s
+         */
+        float bankAt(float s) const;
+
+        // the raw grid values (for uploading to the GPU)
+        std::pmr::vector<glm::vec3> const &gridPositions() const;
+        std::pmr::vector<glm::quat> const &gridFrames() const;
+        std::pmr::vector<float> const &gridBanks() const;
+
+        // the grid as two texels per point, the position with the bank then the frame (what GpuCarts uploads)
+        void packTexels(std::vector<glm::vec4> &texels) const;
+
+    private:
+        std::pmr::vector<glm::vec3> m_positions{memory::rebuildResource()};
+        std::pmr::vector<glm::quat> m_frames{memory::rebuildResource()};
+        std::pmr::vector<float> m_bank{memory::rebuildResource()};
+        float m_delta_s = 1.f;
+        float m_length = 0.f;
+
+        // finds the grid interval containing s and the interpolation factor within it
+        void locate(float s, size_t &index_a, size_t &index_b, float &t) const;
+
+        // the bank angle between two grid points
+        float bankBetween(size_t index_a, size_t index_b, float t) const;
+    };
+
+    /**
+     * Generates rotation minimizing frames along a closed polyline using the double reflection method
+     * (Wang et al. 2008). The twist left over when the loop closes is spread evenly along the curve.
+     * @param points the sample positions (the curve is assumed to wrap from the last point to the first)
+     * @param tangents the unit tangents at each sample
+     * @param up the preferred normal direction for the first frame
+     * @return one quaternion per sample with columns (B, N, T), allocated from the same resource as points
+     */
+    std::pmr::vector<glm::quat> calculateRotationMinimizingFrames(
+        std::pmr::vector<glm::vec3> const &points, std::pmr::vector<glm::vec3> const &tangents, glm::vec3 up);
+
+    /*
+     * calculateRotationMinimizingFrames in parts, so a long track can be done a slice at a time:
+     * firstFrameNormal, then propagateFrames over [0, n) in order, closingTwist, then distributeClosingTwist over [0, n)
+     */
+
+    // the normal of the first frame, up projected off the first tangent (any perpendicular if they line up)
+    glm::vec3 firstFrameNormal(glm::vec3 const &tangent, glm::vec3 up);
+
+    /**
+     * write the frames [begin, end) without the closing twist by double reflection, the slices must run in order
+     * @param normal the normal at begin, left as the normal at end (carried around onto the first point when end = n)
+     */
+    void propagateFrames(std::pmr::vector<glm::vec3> const &points, std::pmr::vector<glm::vec3> const &tangents,
+                         std::pmr::vector<glm::quat> &frames, size_t begin, size_t end, glm::vec3 &normal);
+
+    // the signed angle (around the first tangent) that takes the normal carried around the loop back onto the first one
+    float closingTwist(glm::vec3 const &end_normal, glm::vec3 const &first_normal, glm::vec3 const &first_tangent);
+
+    // spread the closing twist evenly over frames [begin, end) so the loop joins up without a seam
+    void distributeClosingTwist(std::pmr::vector<glm::quat> &frames, float closing, size_t begin, size_t end);
+
+    /**
+     * get the banking angle that rotates the normal of a frame onto the direction of a (perpendicular to the tangent)
+     */
+    float bankAngle(glm::quat const &frame, glm::vec3 a);
+}
@@ -0,0 +1,178 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "gpu_carts.hpp"
+#include "metrics.hpp"
+#include <vector>
+
+namespace rendering
+{
+    namespace
+    {
+        // texel 2i is (position, bank) and texel 2i + 1 the rotation minimizing frame (x, y, z, w) of grid point i
+        const char *carts_vertex_source = R"shader(#version 330 core
+#define M_PI 3.1415926535897932384626433832795
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in float s;
+
+uniform samplerBuffer frames;
+uniform int numFrames;
+uniform float trackLength;
+uniform float deltaS;
+uniform float scale;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 fragNormal;
+out vec3 originalPosition;
+out vec3 fragBarycentricCoords;
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    vec3 t = 2.0 * cross(q.xyz, v);
+    return v + q.w * t + cross(q.xyz, t);
+}
+
+vec4 multiply(vec4 a, vec4 b)
+{
+    return vec4(a.w * b.xyz + b.w * a.xyz + cross(a.xyz, b.xyz), a.w * b.w - dot(a.xyz, b.xyz));
+}
+
+void main()
+{
+    // find the grid interval like FrameCache::locate
+    float x = mod(s, trackLength) / deltaS;
+    float index = floor(x);
+    float t = x - index;
+    int a = int(index) % numFrames;
+    int b = (a + 1) % numFrames;
+
+    vec4 p_a = texelFetch(frames, 2 * a);
+    vec4 p_b = texelFetch(frames, 2 * b);
+    vec4 q_a = texelFetch(frames, 2 * a + 1);
+    vec4 q_b = texelFetch(frames, 2 * b + 1);
+
+    // nlerp the frames and twist around the tangent by the bank angle (taking the short way around)
+    if (dot(q_a, q_b) < 0.0) q_b = -q_b;
+    vec4 q = normalize(mix(q_a, q_b, t));
+    float d = p_b.w - p_a.w;
+    d -= 2.0 * M_PI * floor(d / (2.0 * M_PI) + 0.5);
+    float bank = 0.5 * (p_a.w + d * t);
+    q = multiply(q, vec4(0.0, 0.0, sin(bank), cos(bank)));
+
+    vec3 world = mix(p_a.xyz, p_b.xyz, t) + rotate(q, scale * position);
+    gl_Position = projection * view * vec4(world, 1.0);
+    originalPosition = world;
+    fragNormal = rotate(q, normal);
+    fragBarycentricCoords = vec3(1.0);
+}
+)shader";
+    }
+
+    GpuCarts::GpuCarts(givr::geometry::Mesh const &mesh, givr::style::Phong const &style, float scale)
+        : m_style(style), m_scale(scale)
+    {
+        m_program = std::make_unique<givr::Program>(
+            givr::Shader{carts_vertex_source, GL_VERTEX_SHADER},
+            givr::Shader{givr::style::phongFragmentSource(false, false), GL_FRAGMENT_SHADER});
+
+        givr::geometry::Mesh::Data data = givr::geometry::generateGeometry(mesh);
+        m_index_count = GLsizei(data.indices.size());
+
+        m_vao.bind();
+        m_vertices.bind(GL_ARRAY_BUFFER);
+        m_vertices.data(GL_ARRAY_BUFFER, data.vertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        if (data.normals.empty())
+        {
+            glVertexAttrib3f(1, 0.0f, 1.0f, 0.0f);
+        }
+        else
+        {
+            m_normals.bind(GL_ARRAY_BUFFER);
+            m_normals.data(GL_ARRAY_BUFFER, data.normals, GL_STATIC_DRAW);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        }
+
+        // one s value per instance
+        m_instances.bind(GL_ARRAY_BUFFER);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+        glVertexAttribDivisor(2, 1);
+
+        m_indices.bind(GL_ELEMENT_ARRAY_BUFFER);
+        m_indices.data(GL_ELEMENT_ARRAY_BUFFER, data.indices, GL_STATIC_DRAW);
+        m_vao.unbind();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void GpuCarts::upload(modelling::FrameCache const &frames)
+    {
+        std::vector<glm::vec4> texels;
+        frames.packTexels(texels);
+        upload(frames, texels);
+    }
+
+    void GpuCarts::upload(modelling::FrameCache const &frames, std::vector<glm::vec4> const &texels)
+    {
+        m_frames.upload(texels.data(), texels.size());
+        m_num_frames = int(frames.size());
+        m_length = frames.length();
+        m_delta_s = frames.deltaS();
+    }
+
+    void GpuCarts::draw(glm::mat4 const &view, glm::mat4 const &projection, glm::vec3 view_position,
+                        float const *s, size_t count)
+    {
+        if (m_num_frames == 0 || count == 0)
+        {
+            return;
+        }
+
+        // orphan the old storage when it is too small, otherwise overwrite in place
+        m_instances.bind(GL_ARRAY_BUFFER);
+        if (count > m_instance_capacity)
+        {
+            m_instance_capacity = count;
+            glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(count * sizeof(float)), s, GL_STREAM_DRAW);
+        }
+        else
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(count * sizeof(float)), s);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        METRICS_ADD(INSTANCE_UPLOADS, 1);
+        METRICS_ADD(BYTES_UPLOADED, count * sizeof(float));
+
+        using namespace givr::style;
+        m_program->use();
+        m_program->setMat4("view", view);
+        m_program->setMat4("projection", projection);
+        m_program->setVec3("viewPosition", view_position);
+        m_program->setInt("frames", 0);
+        m_program->setInt("numFrames", m_num_frames);
+        m_program->setFloat("trackLength", m_length);
+        m_program->setFloat("deltaS", m_delta_s);
+        m_program->setFloat("scale", m_scale);
+        m_program->setVec3("colour", m_style.value<Colour>());
+        m_program->setVec3("lightPosition", m_style.value<LightPosition>());
+        m_program->setFloat("ambientFactor", m_style.value<AmbientFactor>());
+        m_program->setFloat("specularFactor", m_style.value<SpecularFactor>());
+        m_program->setFloat("phongExponent", m_style.value<PhongExponent>());
+        m_program->setBool("perVertexColour", false);
+        m_program->setBool("showWireFrame", false);
+
+        m_frames.bind(0);
+        m_vao.bind();
+        glDrawElementsInstanced(GL_TRIANGLES, m_index_count, GL_UNSIGNED_INT, nullptr, GLsizei(count));
+        m_vao.unbind();
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "givr.h"
+#include "frame_cache.hpp"
+#include "buffer_texture.hpp"
+#include <memory>
+#include <vector>
+
+namespace rendering
+{
+    /**
+     * Instanced cart renderer that places the carts on the GPU.
+     * The frame cache (positions, rotation minimizing frames and bank angles on the uniform s grid) is uploaded
+     * once per rebuild as a buffer texture, each cart instance is then a single float s and the vertex shader
+     * does the same lookup as FrameCache::operator() (lerp/nlerp between grid points plus the bank twist).
+     * Shading reuses givr's phong fragment shader.
+     */
+    class GpuCarts
+    {
+    public:
+        /**
+         * loads the mesh and compiles the shader, needs a current GL context
+         * @param mesh the cart model
+         * @param style the phong parameters to shade it with
+         * @param scale the uniform scale applied to the model (matches the cpu cart transforms)
+         */
+        GpuCarts(givr::geometry::Mesh const &mesh, givr::style::Phong const &style, float scale);
+
+        GpuCarts(const GpuCarts &) = delete;
+        GpuCarts &operator=(const GpuCarts &) = delete;
+
+        // upload the frames, call again whenever the frame cache is rebuilt
+        void upload(modelling::FrameCache const &frames);
+
+        // upload frames already packed with FrameCache::packTexels (so the packing can happen before the frame)
+        void upload(modelling::FrameCache const &frames, std::vector<glm::vec4> const &texels);
+
+        /**
+         * draw one cart at every s value (4 bytes per cart are uploaded)
+         * @param s the arc length positions of the carts (wrapped around the track in the shader)
+         * @param count the number of carts
+         */
+        void draw(glm::mat4 const &view, glm::mat4 const &projection, glm::vec3 view_position,
+                  float const *s, size_t count);
+
+        // draw with a givr view context
+        template <typename ViewContextT>
+        void draw(ViewContextT const &view, float const *s, size_t count)
+        {
+            draw(view.camera.viewMatrix(), view.projection.projectionMatrix(), view.camera.viewPosition(), s, count);
+        }
+
+    private:
+        std::unique_ptr<givr::Program> m_program;
+        givr::style::Phong m_style;
+        float m_scale;
+
+        givr::VertexArray m_vao;
+        givr::Buffer m_vertices;
+        givr::Buffer m_normals;
+        givr::Buffer m_indices;
+        givr::Buffer m_instances;
+        GLsizei m_index_count = 0;
+        size_t m_instance_capacity = 0;
+
+        BufferTexture m_frames;
+        int m_num_frames = 0;
+        float m_length = 0.0f;
+        float m_delta_s = 1.0f;
+    };
+}
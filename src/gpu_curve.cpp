@@ -0,0 +1,100 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "gpu_curve.hpp"
+#include <vector>
+
+namespace rendering
+{
+    namespace
+    {
+        // texels 4i to 4i + 3 are the power form coefficients of segment i
+        const char *curve_vertex_source = R"shader(#version 330 core
+uniform samplerBuffer controlPoints;
+uniform int numPoints;
+uniform int numSamples;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    // U in [0, 1) (the line loop closes the curve), same localization as Curve
+    float U = float(gl_VertexID) / float(numSamples);
+    float float_seg = U * float(numPoints);
+    int seg = min(int(floor(float_seg)), numPoints - 1);
+    float u = float_seg - float(seg);
+
+    vec3 c0 = texelFetch(controlPoints, 4 * seg).xyz;
+    vec3 c1 = texelFetch(controlPoints, 4 * seg + 1).xyz;
+    vec3 c2 = texelFetch(controlPoints, 4 * seg + 2).xyz;
+    vec3 c3 = texelFetch(controlPoints, 4 * seg + 3).xyz;
+
+    // the basis was already applied on the CPU
+    vec3 p = c0 + u * (c1 + u * (c2 + u * c3));
+
+    gl_Position = projection * view * vec4(p, 1.0);
+}
+)shader";
+
+        const char *curve_fragment_source = R"shader(#version 330 core
+uniform vec3 colour;
+out vec4 outColour;
+
+void main()
+{
+    outColour = vec4(colour, 1.0);
+}
+)shader";
+    }
+
+    GpuCurve::GpuCurve()
+    {
+        m_program = std::make_unique<givr::Program>(
+            givr::Shader{curve_vertex_source, GL_VERTEX_SHADER},
+            givr::Shader{curve_fragment_source, GL_FRAGMENT_SHADER});
+    }
+
+    void GpuCurve::upload(modelling::CoasterCurve const &curve)
+    {
+        using Basis = modelling::CoasterCurve::basis_type;
+        std::vector<glm::vec4> texels;
+        texels.reserve(4 * curve.size());
+        for (size_t seg = 0; seg < curve.size(); seg++)
+        {
+            glm::vec3 G[4];
+            glm::vec3 c[4];
+            Basis::geometry(curve.controlPoints(), seg, G);
+            modelling::powerCoefficients<Basis>(G, c);
+            for (glm::vec3 const &coefficient : c)
+            {
+                texels.emplace_back(coefficient, 0.0f);
+            }
+        }
+        m_control_points.upload(texels.data(), texels.size());
+        m_num_control_points = int(curve.size());
+    }
+
+    void GpuCurve::draw(glm::mat4 const &view, glm::mat4 const &projection, int samples, glm::vec3 colour)
+    {
+        if (m_num_control_points == 0 || samples < 2)
+        {
+            return;
+        }
+
+        m_program->use();
+        m_program->setMat4("view", view);
+        m_program->setMat4("projection", projection);
+        m_program->setVec3("colour", colour);
+        m_program->setInt("numPoints", m_num_control_points);
+        m_program->setInt("numSamples", samples);
+        m_program->setInt("controlPoints", 0);
+
+        m_control_points.bind(0);
+        m_vao.bind();
+        glDrawArrays(GL_LINE_LOOP, 0, samples);
+        m_vao.unbind();
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "givr.h"
+#include "hermite_curve.hpp"
+#include "buffer_texture.hpp"
+#include <memory>
+
+namespace rendering
+{
+    /**
+     * Draws the coaster curve as a line loop evaluated entirely on the GPU.
+     * Only the power form coefficients of each segment are uploaded (as a buffer texture), so one shader draws
+     * any basis: the vertex shader finds the segment and evaluates its cubic from gl_VertexID, so changing the
+     * number of samples costs nothing
+     * on the CPU. Needs GL 3.3 core only (no compute or transform feedback) so it also runs on Mesa's llvmpipe.
+     */
+    class GpuCurve
+    {
+    public:
+        // compiles the shader, needs a current GL context
+        GpuCurve();
+
+        GpuCurve(const GpuCurve &) = delete;
+        GpuCurve &operator=(const GpuCurve &) = delete;
+
+        // upload the segments of a curve, call again whenever the curve changes
+        void upload(modelling::CoasterCurve const &curve);
+
+        /**
+         * draw the curve
+         * @param view the view matrix
+         * @param projection the projection matrix
+         * @param samples the number of points evaluated along the whole curve
+         * @param colour the line colour
+         */
+        void draw(glm::mat4 const &view, glm::mat4 const &projection, int samples, glm::vec3 colour);
+
+        // draw with a givr view context
+        template <typename ViewContextT>
+        void draw(ViewContextT const &view, int samples, glm::vec3 colour)
+        {
+            draw(view.camera.viewMatrix(), view.projection.projectionMatrix(), samples, colour);
+        }
+
+    private:
+        std::unique_ptr<givr::Program> m_program;
+        // core profile needs a vertex array bound even though there are no attributes
+        givr::VertexArray m_vao;
+        BufferTexture m_control_points;
+        int m_num_control_points = 0;
+    };
+}
@@ -0,0 +1,101 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "gpu_rails.hpp"
+
+namespace rendering
+{
+    namespace
+    {
+        // the mesh is already in world space
+        const char *rails_vertex_source = R"shader(#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 fragNormal;
+out vec3 originalPosition;
+out vec3 fragBarycentricCoords;
+
+void main()
+{
+    gl_Position = projection * view * vec4(position, 1.0);
+    originalPosition = position;
+    fragNormal = normal;
+    fragBarycentricCoords = vec3(1.0);
+}
+)shader";
+    }
+
+    GpuRails::GpuRails(givr::style::Phong const &style)
+        : m_style(style)
+    {
+        m_program = std::make_unique<givr::Program>(
+            givr::Shader{rails_vertex_source, GL_VERTEX_SHADER},
+            givr::Shader{givr::style::phongFragmentSource(false, false), GL_FRAGMENT_SHADER});
+
+        m_vao.bind();
+        m_vertices.bind(GL_ARRAY_BUFFER);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        m_normals.bind(GL_ARRAY_BUFFER);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        m_indices.bind(GL_ELEMENT_ARRAY_BUFFER);
+        m_vao.unbind();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void GpuRails::upload(modelling::RailMesh const &mesh)
+    {
+        m_vertices.bind(GL_ARRAY_BUFFER);
+        m_vertices.data(GL_ARRAY_BUFFER, mesh.positions, GL_STATIC_DRAW);
+        m_normals.bind(GL_ARRAY_BUFFER);
+        m_normals.data(GL_ARRAY_BUFFER, mesh.normals, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // the element buffer belongs to the vertex array
+        m_vao.bind();
+        m_indices.bind(GL_ELEMENT_ARRAY_BUFFER);
+        m_indices.data(GL_ELEMENT_ARRAY_BUFFER, mesh.indices, GL_STATIC_DRAW);
+        m_vao.unbind();
+
+        m_index_count = GLsizei(mesh.indices.size());
+        m_vertex_count = mesh.positions.size();
+    }
+
+    size_t GpuRails::vertexCount() const
+    {
+        return m_vertex_count;
+    }
+
+    void GpuRails::draw(glm::mat4 const &view, glm::mat4 const &projection, glm::vec3 view_position)
+    {
+        if (m_index_count == 0)
+        {
+            return;
+        }
+
+        using namespace givr::style;
+        m_program->use();
+        m_program->setMat4("view", view);
+        m_program->setMat4("projection", projection);
+        m_program->setVec3("viewPosition", view_position);
+        m_program->setVec3("colour", m_style.value<Colour>());
+        m_program->setVec3("lightPosition", m_style.value<LightPosition>());
+        m_program->setFloat("ambientFactor", m_style.value<AmbientFactor>());
+        m_program->setFloat("specularFactor", m_style.value<SpecularFactor>());
+        m_program->setFloat("phongExponent", m_style.value<PhongExponent>());
+        m_program->setBool("perVertexColour", false);
+        m_program->setBool("showWireFrame", false);
+
+        m_vao.bind();
+        glDrawElements(GL_TRIANGLES, m_index_count, GL_UNSIGNED_INT, nullptr);
+        m_vao.unbind();
+    }
+}
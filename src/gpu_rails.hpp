@@ -0,0 +1,54 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "givr.h"
+#include "rail_mesh.hpp"
+#include <memory>
+
+namespace rendering
+{
+    /**
+     * Draws the swept track mesh (see modelling::sweepRails) in a single indexed draw call.
+     * The mesh is uploaded once per rebuild and drawn as is, shading reuses givr's phong fragment shader.
+     */
+    class GpuRails
+    {
+    public:
+        // compiles the shader, needs a current GL context
+        GpuRails(givr::style::Phong const &style);
+
+        GpuRails(const GpuRails &) = delete;
+        GpuRails &operator=(const GpuRails &) = delete;
+
+        // upload a mesh, call again whenever the frame cache is rebuilt
+        void upload(modelling::RailMesh const &mesh);
+
+        // the number of vertices uploaded
+        size_t vertexCount() const;
+
+        void draw(glm::mat4 const &view, glm::mat4 const &projection, glm::vec3 view_position);
+
+        // draw with a givr view context
+        template <typename ViewContextT>
+        void draw(ViewContextT const &view)
+        {
+            draw(view.camera.viewMatrix(), view.projection.projectionMatrix(), view.camera.viewPosition());
+        }
+
+    private:
+        std::unique_ptr<givr::Program> m_program;
+        givr::style::Phong m_style;
+
+        givr::VertexArray m_vao;
+        givr::Buffer m_vertices;
+        givr::Buffer m_normals;
+        givr::Buffer m_indices;
+        GLsizei m_index_count = 0;
+        size_t m_vertex_count = 0;
+    };
+}
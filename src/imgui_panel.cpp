@@ -9,8 +9,11 @@
 
 #include "imgui_panel.hpp"
 
+#include <algorithm>
 #include <array>
 
+#include "profiler.hpp"
+
 namespace imgui_panel {
 	// default values
 	bool showPanel = true;
@@ -24,22 +27,60 @@ namespace imgui_panel {
 
 	// bonus stuff
 	int num_carts = 4;
+	bool gpu_carts = false;
+	bool swept_rails = false;
+	size_t rail_vertices = 0;
+	bool adaptive_spacing = false;
+	float max_visual_error = ADAPTIVE_MAX_ERROR;
+	bool update_spacing = false;
+	size_t num_track_pieces = 0;
+	size_t num_supports = 0;
 	bool use_moving_camera = false;
 
 	// visualization
 	bool resample = true;
 	int curveSamples = 300;
+	bool gpu_curve_sampling = false;
 	bool show_curve = false;
 
 	// loading
 	bool rereadControlPoints = false;
 	bool clearControlPointsFilePath = false;
 	std::string controlPointsFilePath = "./roller_coaster.obj";
+	bool saveControlPoints = false;
+	bool loading = false;
+	bool cancel_load = false;
+	float load_progress = 0.0f;
+	const char* load_stage = "Idle";
+
+	// editing
+	float edit_budget_ms = 4.0f;
+	bool editing = false;
+	size_t edit_point = 0;
+	float edit_progress = 0.0f;
+
+	// validation
+	modelling::ClearanceSettings clearance_settings;
+	bool check_clearance = false;
+	modelling::ClearanceReport clearance_report;
+
+	// trees
+	int tree_seed = int(TREE_SEED);
+	bool scatter_trees = false;
 
 	// animation
 	bool play = false;
 	bool resetView = false;
 
+	// statistics
+	size_t frame_allocations = 0;
+	size_t load_parse_allocations = 0;
+	size_t load_allocations = 0;
+	bool export_trace = false;
+	metrics::Snapshot frame_metrics;
+	metrics::Snapshot rebuild_metrics;
+	std::vector<tasks::TaskScheduler::TaskTiming> task_timings;
+
 	std::function<void(void)> draw = [](void) {
 		if (!showPanel) return;
 
@@ -61,22 +102,68 @@ namespace imgui_panel {
 			if (ImGui::CollapsingHeader("Visualization")) {
 				ImGui::SliderInt("Curve Samples", &curveSamples, 5, 1000);
 				resample = ImGui::Button("Resample Curve");
+				// evaluates the curve in the vertex shader, the sample count applies straight away
+				ImGui::Checkbox("Sample curve on GPU", &gpu_curve_sampling);
 			}
 
 			ImGui::Spacing();
 			if (ImGui::CollapsingHeader("Loading control points")) {
 				static std::array<char, 64> buffer;
-				ImGui::InputText("(OBJ) file", buffer.data(), buffer.size());
+				ImGui::InputText("(OBJ/HCB/TXT) file", buffer.data(), buffer.size());
 
 				rereadControlPoints = ImGui::Button("Load");
 				ImGui::SameLine();
+				saveControlPoints = ImGui::Button("Save");
+				ImGui::SameLine();
 				clearControlPointsFilePath = ImGui::Button("Clear");
 
-				if (rereadControlPoints) controlPointsFilePath = buffer.data();
+				if (rereadControlPoints || saveControlPoints) controlPointsFilePath = buffer.data();
 				if (clearControlPointsFilePath) {
 					buffer = std::array<char, 64>();
 					clearControlPointsFilePath = false;
 				}
+
+				// the track loads in the background, show where it is
+				ImGui::ProgressBar(load_progress, ImVec2(-1.0f, 0.0f), load_stage);
+				if (loading) {
+					cancel_load = ImGui::Button("Cancel");
+				}
+			}
+
+			ImGui::Spacing();
+			if (ImGui::CollapsingHeader("Editing")) {
+				ImGui::Text("Right drag a control point to move it");
+				// the rebuild after an edit only gets this much of each frame, the rest carries over
+				ImGui::SliderFloat("Rebuild budget (ms)", &edit_budget_ms, 0.5f, 16.0f);
+				if (editing) {
+					ImGui::Text("Control point %zu", edit_point);
+					ImGui::ProgressBar(edit_progress, ImVec2(-1.0f, 0.0f), "Rebuilding track");
+				}
+			}
+
+			ImGui::Spacing();
+			if (ImGui::CollapsingHeader("Validation")) {
+				ImGui::SliderFloat("Clearance", &clearance_settings.clearance, 0.5f, 10.0f);
+				ImGui::SliderFloat("Neighbour distance (s)", &clearance_settings.neighbour_s, 1.0f, 50.0f);
+				ImGui::SliderFloat("Support radius", &clearance_settings.support_radius, 0.1f, 5.0f);
+				check_clearance = ImGui::Button("Check clearance");
+
+				ImGui::Text("%zu samples checked in %.2f ms", clearance_report.samples, clearance_report.ms);
+				ImGui::Text("%zu close sections, %zu supports through the track",
+					clearance_report.track.size(), clearance_report.supports.size());
+				for (auto const& v : clearance_report.track) {
+					ImGui::BulletText("s %.1f to %.1f comes within %.2f of s %.1f", v.s_begin, v.s_end, v.min_distance, v.other_s);
+				}
+				for (auto const& v : clearance_report.supports) {
+					ImGui::BulletText("support %zu (s %.1f) passes %.2f from s %.1f", v.support, v.support_s, v.min_distance, v.track_s);
+				}
+			}
+
+			ImGui::Spacing();
+			if (ImGui::CollapsingHeader("Trees")) {
+				// the same seed always gives the same layout for a track
+				ImGui::InputInt("Seed", &tree_seed);
+				scatter_trees = ImGui::Button("Scatter trees");
 			}
 
 			ImGui::Spacing();
@@ -111,7 +198,22 @@ namespace imgui_panel {
 			}
 
 			// set the number of carts
-			ImGui::SliderInt("Number of Carts", &num_carts, 1,10);
+			// placing the carts on the GPU only costs a float per cart so allow far more of them
+			if (ImGui::Checkbox("Place carts on GPU", &gpu_carts) && !gpu_carts)
+				num_carts = std::min(num_carts, 10);
+			ImGui::SliderInt("Number of Carts", &num_carts, 1, gpu_carts ? 5000 : 10);
+
+			// one swept mesh instead of a track piece every SEP_DIST
+			ImGui::Checkbox("Swept rail mesh", &swept_rails);
+			if (swept_rails)
+				ImGui::Text("%zu rail vertices", rail_vertices);
+
+			// closer pieces and supports on tight track, fewer on straights
+			if (ImGui::Checkbox("Adaptive spacing", &adaptive_spacing))
+				update_spacing = true;
+			if (adaptive_spacing && ImGui::SliderFloat("Max visual error", &max_visual_error, 0.01f, 0.5f))
+				update_spacing = true;
+			ImGui::Text("%zu track pieces, %zu supports", num_track_pieces, num_supports);
 
 			// allow user to change the simulation speed
 			ImGui::Spacing();
@@ -128,6 +230,55 @@ namespace imgui_panel {
 			float frame_rate = ImGui::GetIO().Framerate;
 			ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
 				1000.0f / frame_rate, frame_rate);
+			ImGui::Text("Heap allocations last frame: %zu", frame_allocations);
+			ImGui::Text("Heap allocations last load: %zu (parsing %zu)", load_allocations, load_parse_allocations);
+
+			// how long the tasks of the last rebuild took
+			if (ImGui::CollapsingHeader("Rebuild tasks")) {
+				for (auto const& timing : task_timings) {
+					ImGui::Text("%-18s %8.3f ms (thread %zu)", timing.name, timing.ms, timing.thread);
+				}
+			}
+
+			// frame times and the profiled zones
+			if (ImGui::CollapsingHeader("Profiler")) {
+				profiling::FrameStats stats = profiling::frameStats();
+				ImGui::Text("Frame %.2f ms  p50 %.2f ms  p99 %.2f ms  max %.2f ms",
+					stats.last_ms, stats.p50_ms, stats.p99_ms, stats.max_ms);
+
+				static std::array<float, profiling::FRAME_HISTORY> frame_times;
+				size_t frame_count = profiling::copyFrameTimes(frame_times.data(), frame_times.size());
+				ImGui::PlotLines("Frame times", frame_times.data(), int(frame_count), 0,
+					nullptr, 0.0f, 2.0f * stats.p99_ms, ImVec2(0.0f, 60.0f));
+
+				// distribution of the recent frame times from 0 to twice the p99
+				static std::array<float, 32> bins;
+				profiling::frameTimeHistogram(bins.data(), bins.size(), 0.0f, std::max(2.0f * stats.p99_ms, 1.0f));
+				ImGui::PlotHistogram("Distribution", bins.data(), int(bins.size()), 0,
+					nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+				static std::array<profiling::ZoneSummary, profiling::MAX_ZONE_NAMES> zones;
+				size_t zone_count = profiling::copyZoneSummaries(zones.data(), zones.size());
+				for (size_t i = 0; i < zone_count; i++) {
+					ImGui::Text("%s %-24s %8.3f ms (avg %8.3f, max %8.3f)", zones[i].gpu ? "GPU" : "CPU",
+						zones[i].name, zones[i].last_ms, zones[i].average_ms, zones[i].max_ms);
+				}
+
+				export_trace = ImGui::Button("Export Chrome trace");
+			}
+
+			// how much work the hot paths did
+			if (ImGui::CollapsingHeader("Metrics")) {
+				if (!metrics::enabled()) {
+					ImGui::Text("Compiled out (build with ENABLE_METRICS=1)");
+				}
+				ImGui::Text("%-18s %12s %12s", "", "last frame", "last rebuild");
+				for (size_t i = 0; i < metrics::COUNTER_COUNT; i++) {
+					metrics::Counter counter = metrics::Counter(i);
+					ImGui::Text("%-18s %12llu %12llu", metrics::counterName(counter),
+						(unsigned long long)frame_metrics[counter], (unsigned long long)rebuild_metrics[counter]);
+				}
+			}
 		}
 		ImGui::End();
 	};
@@ -15,6 +15,9 @@
 #include "givio.h"
 #include "givr.h"
 #include "imgui/imgui.h"
+#include "clearance_check.hpp"
+#include "metrics.hpp"
+#include "task_scheduler.hpp"
 
 namespace imgui_panel {
 
@@ -24,11 +27,32 @@ extern ImVec4 clear_color;
 // visualization
 extern bool resample;
 extern int curveSamples;
+extern bool gpu_curve_sampling;
 
 // loading
 extern bool rereadControlPoints;
 extern bool clearControlPointsFilePath;
 extern std::string controlPointsFilePath;
+extern bool saveControlPoints;
+extern bool loading;
+extern bool cancel_load;
+extern float load_progress;
+extern const char* load_stage;
+
+// editing
+extern float edit_budget_ms;
+extern bool editing;
+extern size_t edit_point;
+extern float edit_progress;
+
+// validation
+extern modelling::ClearanceSettings clearance_settings;
+extern bool check_clearance;
+extern modelling::ClearanceReport clearance_report;
+
+// trees
+extern int tree_seed;
+extern bool scatter_trees;
 
 // animation
 extern bool play;
@@ -40,11 +64,28 @@ extern bool update_lookahead;
 extern float playback_speed;
 extern bool reset_simulation;
 extern int num_carts;
+extern bool gpu_carts;
+extern bool swept_rails;
+extern size_t rail_vertices;
+extern bool adaptive_spacing;
+extern float max_visual_error;
+extern bool update_spacing;
+extern size_t num_track_pieces;
+extern size_t num_supports;
 
 // view controlls
 extern bool use_moving_camera;
 extern bool show_curve;
 
+// statistics
+extern size_t frame_allocations;
+extern size_t load_parse_allocations;
+extern size_t load_allocations;
+extern std::vector<tasks::TaskScheduler::TaskTiming> task_timings;
+extern bool export_trace;
+extern metrics::Snapshot frame_metrics;
+extern metrics::Snapshot rebuild_metrics;
+
 // lambda function
 extern std::function<void(void)> draw;
 
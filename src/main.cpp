@@ -15,11 +15,24 @@
 #include "imgui_panel.hpp"
 #include "arc_length_parameterize.hpp"
 #include "curve_file_io.hpp"
+#include "curve_resample.hpp"
 #include "hermite_curve.hpp"
 #include "RollerCoaster.hpp"
+#include "track_loader.hpp"
+#include "track_editor.hpp"
+#include "clearance_check.hpp"
+#include "gpu_curve.hpp"
+#include "gpu_carts.hpp"
+#include "gpu_rails.hpp"
+#include "profiler.hpp"
+#include "metrics.hpp"
+#include "task_scheduler.hpp"
+#include "frame_arena.hpp"
+#include "alloc_counter.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/transform.hpp>
+#include <cstdlib>
 
 using namespace glm;
 using namespace giv;
@@ -36,6 +49,8 @@ using namespace givr::style;
 #define CART_LENGTH 1.6f
 #define SUPPORT_SPACING 20.0f
 #define NUM_TREES 30
+#define FRAME_ARENA_SIZE (64 * 1024)
+#define PROFILE_TRACE_FILE "profile_trace.json"
 
 
 // This boilerplate sets up work for the Hermite Curve and Arc Length Table. Each will indicate which functions to complete
@@ -54,8 +69,71 @@ const std::vector<glm::vec3> default_cps = {
 	{-10.f, 0.f, 0.f}
 };
 
+/**
+ * headless preprocessing: cpsc587_a1_hh --resample <input> [output] [--tolerance t]
+ * refits the track with evenly spaced control points (see modelling::resampleUniform), the output defaults to
+ * <input>_uniform with the same extension and its format follows the extension like loading does
+ */
+int resampleCommand(int argc, char** argv) {
+	std::vector<std::string> files;
+	float tolerance = RESAMPLE_TOLERANCE;
+	bool valid = true;
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg != "--tolerance") {
+			files.push_back(arg);
+			continue;
+		}
+		// the whole value has to be a number (strtof does not throw, unlike stof)
+		char const* value = i + 1 < argc ? argv[++i] : "";
+		char* end = nullptr;
+		tolerance = std::strtof(value, &end);
+		valid = valid && end != value && *end == '\0';
+	}
+	if (!valid || files.empty() || files.size() > 2 || !(tolerance > 0.f)) {
+		std::cerr << "usage: " << argv[0] << " --resample <input> [output] [--tolerance t]\n";
+		return 1;
+	}
+	std::string input = files[0];
+	std::string output = files.size() > 1 ? files[1] : input;
+	if (files.size() == 1) {
+		size_t dot = input.find_last_of('.');
+		size_t slash = input.find_last_of("/\\");
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = input.size();
+		output = input.substr(0, dot) + "_uniform" + input.substr(dot);
+	}
+
+	std::optional<modelling::HermiteCurve> loaded = modelling::readHermiteCurveFromAnyFile(input);
+	if (!loaded || loaded->size() < 2) {
+		std::cerr << "no track in " << input << '\n';
+		return 1;
+	}
+
+	tasks::TaskScheduler scheduler;
+	modelling::ResampleReport report;
+	modelling::CoasterCurve resampled = modelling::resampleUniform(
+		modelling::CoasterCurve(std::move(loaded->controlPoints())), tolerance, &report, &scheduler);
+	modelling::saveHermiteCurveToAnyFile(modelling::HermiteCurve(std::move(resampled.controlPoints())), output);
+
+	std::cout << input << " -> " << output << '\n'
+		<< "  control points " << report.points_before << " -> " << report.points_after << '\n'
+		<< "  max / min spacing " << report.spacing_ratio_before << " -> " << report.spacing_ratio_after << '\n'
+		<< "  table u steps (x even spacing) " << report.step_factor_before << " -> " << report.step_factor_after << '\n'
+		<< "  length " << report.length_before << " -> " << report.length_after << '\n'
+		<< "  max error " << report.max_error << " (tolerance " << tolerance << "), " << report.ms << " ms\n";
+	if (report.max_error > tolerance) {
+		std::cerr << "could not reach the tolerance with " << RESAMPLE_MAX_POINTS << " points\n";
+		return 1;
+	}
+	return 0;
+}
+
 // program entry point
-int main(void) {
+int main(int argc, char** argv) {
+	// preprocessing runs without a window
+	if (argc > 1 && std::string(argv[1]) == "--resample")
+		return resampleCommand(argc, argv);
+
 	// initialize OpenGL and window
 	GLFWContext glContext;
 	glContext.glMajorVesion(3)
@@ -89,8 +167,8 @@ int main(void) {
 		| Key(GLFW_KEY_P, toggle_panel);
 
 	// initial curve --
-	modelling::HermiteCurve curve(
-		modelling::HermiteCurve::buildControlPoints(default_cps)
+	modelling::CoasterCurve curve(
+		modelling::CoasterCurve::buildControlPoints(default_cps)
 	);
 
 	//To load the arc length parameterized curve (only worth part marks so only do this if you need to):
@@ -111,15 +189,24 @@ int main(void) {
 	GL_Line track_style = GL_Line(Width(15.), Colour(0.2, 0.7, 1.0));
 	RenderContext track_render = createRenderable(track_geometry, track_style);
 
+	// the same curve evaluated in the vertex shader (only the control points are uploaded)
+	rendering::GpuCurve gpu_curve;
+	gpu_curve.upload(curve);
+
 	// Cart
 	Mesh cart_geometry = Mesh(Filename("./models/cart.obj"));
 	PhongStyle cart_style = Phong(Colour(1.f, 1.f, 0.0f), LightPosition(100.f, 100.f, 100.f));
 	InstancedRenderContext cart_renders = createInstancedRenderable(cart_geometry, cart_style);
+	// the same carts placed by the vertex shader from the frame cache
+	rendering::GpuCarts gpu_carts(cart_geometry, cart_style, TRACK_SCALE);
 
 	// Track peice
 	Mesh track_piece = Mesh(Filename("./models/track_piece.obj"));
 	PhongStyle track_piece_style = Phong(Colour(0.0f, 1.0f, 1.0f), LightPosition(100.0f, 100.0f, 100.0f));
 	InstancedRenderContext track_piece_render = createInstancedRenderable(track_piece, track_piece_style);
+	// or one mesh swept along the frames
+	rendering::GpuRails gpu_rails(track_piece_style);
+	bool rails_stale = true;
 
 	// ground
 	Mesh ground_geometry = Mesh(Filename("./models/Ground.obj"));
@@ -137,29 +224,89 @@ int main(void) {
 	PhongStyle sup_style = Phong(Colour(0.0f, 1.0f, 1.0f), LightPosition(100.0f, 100.0f, 100.0f));
 	InstancedRenderContext sup_render = createInstancedRenderable(sup_geometry, sup_style);
 
+	// worker threads for the modelling rebuilds (must outlive the roller coasters and the loader)
+	tasks::TaskScheduler scheduler;
+
+	// makes a roller coaster with the motion parameters that rebuilds on the scheduler
+	auto make_roller_coaster = [&]() {
+		modelling::RollerCoaster rc(SEP_DIST, MIN_V, DEC_FRAC, DELTA_S, imgui_panel::look_ahead, SUPPORT_SPACING, NUM_TREES);
+		rc.SetScheduler(&scheduler);
+		rc.SetTreeSeed(uint32_t(imgui_panel::tree_seed));
+		rc.SetAdaptiveSpacing(imgui_panel::adaptive_spacing, imgui_panel::max_visual_error);
+		return rc;
+	};
+
 	// roller coaster object managers the roller coaster
-	modelling::RollerCoaster roller_coaster(SEP_DIST, MIN_V, DEC_FRAC, DELTA_S, imgui_panel::look_ahead, SUPPORT_SPACING, NUM_TREES);
-
-	// try loading roller coaster 1 as the initial roller coaster
-	std::optional<modelling::HermiteCurve> optional_curve = modelling::readHermiteCurveFrom_OBJ_File(Filename("models/roller_coaster_1.obj"));
-	if(optional_curve)
-	{
-		// set the existing curve to the new curve vales
-		curve = optional_curve.value();
-
-		// update the redered geometry to represent the new curve
-		cp_geometry = curve.controlPointFrameGeometry();
-		cp_t_geometry = curve.controlPointGeometry();
-		track_geometry = curve.sampledGeometry(imgui_panel::curveSamples);
-
-		updateRenderable(cp_geometry, cp_style, cp_render);
-		updateRenderable(cp_t_geometry, cp_t_style, cp_t_render);
-		updateRenderable(track_geometry, track_style, track_render);
-	}
-	roller_coaster.UpdateCurve(curve);
+	modelling::RollerCoaster roller_coaster = make_roller_coaster();
+
+	// start with the default curve so there is something to draw while the first track loads
+	// (the roller coaster owns the curve from here on, use GetCurve)
+	roller_coaster.UpdateCurve(std::move(curve));
+
+	// the carts read the frames on the GPU, the rail mesh is swept again the next time it is drawn
+	auto upload_frames = [&]() {
+		gpu_carts.upload(roller_coaster.GetFrameCache());
+		rails_stale = true;
+	};
+	upload_frames();
+
+	// right drag moves control points, the track catches up within a per frame budget
+	modelling::TrackEditor track_editor;
+	CursorPosition cursor{ 0.0, 0.0 };
+	// the ray through the cursor from the near plane to the far plane
+	auto cursor_ray = [&](glm::vec3& origin, glm::vec3& direction) {
+		mat4f inverse_vp = glm::inverse(view.projection.projectionMatrix() * view.camera.viewMatrix());
+		origin = pixelToWorld3D(int(cursor.x), int(cursor.y), window.width(), window.height(), inverse_vp, -1.f);
+		direction = pixelToWorld3D(int(cursor.x), int(cursor.y), window.width(), window.height(), inverse_vp, 1.f) - origin;
+	};
+	window.mouseCommands() | MouseButton(GLFW_MOUSE_BUTTON_RIGHT, [&](auto event) {
+		if (event.action == GLFW_PRESS) {
+			glm::vec3 origin, direction;
+			cursor_ray(origin, direction);
+			track_editor.pick(roller_coaster, origin, direction);
+		}
+		else {
+			track_editor.release();
+		}
+	});
+	// the camera controls still see every movement so they do not jump on the next left drag
+	CursorCommand camera_cursor = window.cursorCommand();
+	window.cursorCommand() = [&, camera_cursor](auto event) {
+		cursor = event;
+		camera_cursor(event);
+		if (track_editor.dragging()) {
+			glm::vec3 origin, direction;
+			cursor_ray(origin, direction);
+			track_editor.drag(origin, direction);
+		}
+	};
+
+	// try loading roller coaster 1 as the initial roller coaster (in the background)
+	modelling::TrackLoader track_loader;
+	track_loader.start("models/roller_coaster_1.obj", make_roller_coaster(), imgui_panel::curveSamples);
 
 	// the s position of the roller coaster
 	float s = 0;
+
+	// scratch memory for the frame loop, released at the start of every frame
+	memory::FrameArena frame_arena(FRAME_ARENA_SIZE);
+	size_t last_allocation_count = memory::heapAllocationCount();
+	std::vector<tasks::TaskScheduler::TaskTiming> task_timings;
+
+	// count the per instance uploads givr makes
+	givr::instanceUploadHook = [](size_t instances, size_t bytes) {
+		(void)instances;
+		(void)bytes;
+		METRICS_ADD(INSTANCE_UPLOADS, 1);
+		METRICS_ADD(BYTES_UPLOADED, bytes);
+	};
+	metrics::Snapshot last_metrics = metrics::threadSink().snapshot();
+
+	// draws a render context inside a CPU and GPU profiling zone
+	auto profiled_draw = [&](const char* name, auto& render_context) {
+		PROFILE_GPU_SCOPE(name);
+		draw(render_context, view);
+	};
 	
 	// main loop
 	// To load a model place it in the "models" directory, build, then type "./models/[name].obj" and press load.
@@ -167,53 +314,142 @@ int main(void) {
 	// Backspace isnt enabled when the panel is over the window, please move the panel off the window to backspace.
 	//
 	mainloop(std::move(window), [&](float dt /**** Time since last frame ****/) {
+		profiling::newFrame();
+
+		// count the heap allocations made during the whole of the last frame
+		size_t allocation_count = memory::heapAllocationCount();
+		imgui_panel::frame_allocations = allocation_count - last_allocation_count;
+		last_allocation_count = allocation_count;
+		frame_arena.reset();
+
+		// the hot path counters of the last frame, the render thread and the tasks it handed out (rebuilds count on their own)
+		metrics::Snapshot current_metrics = metrics::threadSink().snapshot();
+		imgui_panel::frame_metrics = current_metrics - last_metrics;
+		last_metrics = current_metrics;
+
 		if (imgui_panel::resetView)
 			view.camera.reset();
 
-		// load new controll points
+		// load new controll points on the loading thread
 		if (imgui_panel::rereadControlPoints) {
-			// Try to load new control points as a HermiteCurve if possible
-			std::optional<modelling::HermiteCurve> optional_curve 
-			= modelling::readHermiteCurveFrom_OBJ_File(
-				imgui_panel::controlPointsFilePath
-			);
-			// if curve is valid then update geometry data
-			if (optional_curve) {
-				// set the existing curve to the new curve vales
-				curve = optional_curve.value();
-
-				// update the redered geometry to represent the new curve
-				cp_geometry = curve.controlPointFrameGeometry();
-				cp_t_geometry = curve.controlPointGeometry();
-				track_geometry = curve.sampledGeometry(imgui_panel::curveSamples);
-
-				updateRenderable(cp_geometry, cp_style, cp_render);
-				updateRenderable(cp_t_geometry, cp_t_style, cp_t_render);
-				updateRenderable(track_geometry, track_style, track_render);
-
-				// TODO:
-				// convert the curve to a smooth curve
-				// generate the ArcLengthTable
-				
-				// we want the delta u value to result in smaller distance jumps than delta_s
-				// first calculate the maximum change in distance vs change in u max(dS/du)
-				// this is calculated as max_seperation * number_points
-				// then we require that delta_u * dS/du < delta_s or delta_u < du/dS * delta_s
+			track_loader.start(imgui_panel::controlPointsFilePath, make_roller_coaster(), imgui_panel::curveSamples);
+		}
+		// save the current curve in the format of the typed path's extension (.hcb also keeps the tangents)
+		if (imgui_panel::saveControlPoints) {
+			// the file only holds the control points, they read the same in any basis
+			modelling::saveHermiteCurveToAnyFile(modelling::HermiteCurve(roller_coaster.GetCurve().controlPoints()),
+				imgui_panel::controlPointsFilePath);
+		}
+		// not while an edit is rebuilding, the swap would bring back the old trees
+		if (imgui_panel::scatter_trees && !track_editor.editing()) {
+			roller_coaster.SetTreeSeed(uint32_t(imgui_panel::tree_seed));
+			roller_coaster.GenerateTrees();
+		}
+		if (imgui_panel::check_clearance) {
+			imgui_panel::clearance_report = modelling::checkClearance(roller_coaster, imgui_panel::clearance_settings);
+		}
+		if (imgui_panel::export_trace) {
+			profiling::exportChromeTrace(PROFILE_TRACE_FILE);
+		}
+		if (imgui_panel::cancel_load) {
+			track_loader.cancel();
+			imgui_panel::cancel_load = false;
+		}
 
-				roller_coaster.UpdateCurve(curve);
+		// swap in a finished track at the frame boundary
+		std::unique_ptr<modelling::TrackLoader::Result> loaded = track_loader.takeResult();
+		if (loaded) {
+			// take over the new roller coaster (and the curve inside it) without copying
+			roller_coaster = std::move(loaded->roller_coaster);
+			track_editor.cancel();
+			imgui_panel::load_parse_allocations = loaded->parse_allocations;
+			imgui_panel::load_allocations = loaded->load_allocations;
+
+			// upload the geometry staged by the loader
+			cp_geometry = std::move(loaded->cp_geometry);
+			cp_t_geometry = std::move(loaded->cp_t_geometry);
+			track_geometry = std::move(loaded->track_geometry);
+
+			updateRenderable(cp_geometry, cp_style, cp_render);
+			updateRenderable(cp_t_geometry, cp_t_style, cp_t_render);
+			updateRenderable(track_geometry, track_style, track_render);
+			gpu_curve.upload(roller_coaster.GetCurve());
+			upload_frames();
+		}
+		// show the edit straight away on the GPU curve, the track follows once its rebuild finishes
+		if (track_editor.takeCurveChanged()) {
+			gpu_curve.upload(track_editor.curve());
+		}
+		// the editor stages the debug geometry, frame texels and rail mesh over the frames before the swap
+		modelling::TrackEditor::StagingOptions staging_options;
+		staging_options.curve_samples = imgui_panel::gpu_curve_sampling ? 0 : size_t(imgui_panel::curveSamples);
+		staging_options.sweep_rails = imgui_panel::swept_rails;
+		staging_options.scheduler = &scheduler;
+		if (track_editor.update(roller_coaster, imgui_panel::edit_budget_ms, staging_options)) {
+			modelling::TrackEditor::Staged& staged = track_editor.staged();
+			cp_geometry = std::move(staged.cp_geometry);
+			cp_t_geometry = std::move(staged.cp_t_geometry);
+			updateRenderable(cp_geometry, cp_style, cp_render);
+			updateRenderable(cp_t_geometry, cp_t_style, cp_t_render);
+			if (staged.track_geometry) {
+				track_geometry = std::move(*staged.track_geometry);
+				updateRenderable(track_geometry, track_style, track_render);
+			}
+			gpu_carts.upload(roller_coaster.GetFrameCache(), staged.frame_texels);
+			if (staged.rails) {
+				gpu_rails.upload(*staged.rails);
+				imgui_panel::rail_vertices = gpu_rails.vertexCount();
+				rails_stale = false;
+			}
+			else {
+				rails_stale = true;
 			}
 		}
+		imgui_panel::editing = track_editor.editing();
+		imgui_panel::edit_point = track_editor.selected();
+		imgui_panel::edit_progress = track_editor.progress();
+
+		// show how long each rebuild task took (only changes when something was rebuilt)
+		scheduler.takeTimings(task_timings);
+		if (!task_timings.empty()) {
+			imgui_panel::task_timings.swap(task_timings);
+		}
+
+		imgui_panel::loading = track_loader.busy();
+		imgui_panel::load_progress = track_loader.progress();
+		imgui_panel::load_stage = modelling::TrackLoader::stageName(track_loader.stage());
+		imgui_panel::rebuild_metrics = roller_coaster.LastRebuildMetrics();
 
-		if (imgui_panel::resample) {
-			track_geometry = curve.sampledGeometry(imgui_panel::curveSamples);
+		// the GPU path samples every frame so there is nothing to redo on the CPU
+		if (imgui_panel::resample && !imgui_panel::gpu_curve_sampling) {
+			track_geometry = roller_coaster.GetCurve().sampledGeometry(imgui_panel::curveSamples);
 			updateRenderable(track_geometry, track_style, track_render);
 		}
 
-		// animate a train of carts
+		// animate a train of carts (the transforms live in the frame arena until they are drawn)
 		float D = CART_LENGTH*0.5f*float(imgui_panel::num_carts - 1);
-		for(int i = 0; i < imgui_panel::num_carts; i++)
+		std::pmr::vector<glm::mat4> cart_transforms(frame_arena.resource());
+		std::pmr::vector<float> cart_s(frame_arena.resource());
 		{
-			addInstance(cart_renders, roller_coaster.GetTransformAtPosition((s+CART_LENGTH*float(i) - D)));
+			PROFILE_SCOPE("cart instances");
+			if (imgui_panel::gpu_carts)
+			{
+				// only the s values go to the GPU, the shader builds the frames
+				cart_s.resize(imgui_panel::num_carts);
+				for (int i = 0; i < imgui_panel::num_carts; i++)
+				{
+					cart_s[i] = s + CART_LENGTH * float(i) - D;
+				}
+			}
+			else
+			{
+				cart_transforms.resize(imgui_panel::num_carts);
+				for(int i = 0; i < imgui_panel::num_carts; i++)
+				{
+					cart_transforms[i] = roller_coaster.GetTransformAtPosition((s+CART_LENGTH*float(i) - D));
+				}
+				setInstances(cart_renders, cart_transforms);
+			}
 		}
 
 		// if true then make the camera follow the cart
@@ -230,13 +466,25 @@ int main(void) {
 			//printf("speed: %7.3f\n", roller_coaster.GetSpeedAtPos(s));
 		}
 
-		// allow the user to modify the look ahead distance
-		if(imgui_panel::update_lookahead)
+		// allow the user to modify the look ahead distance (after any edit has been swapped in, so it is not lost)
+		if(imgui_panel::update_lookahead && !track_editor.editing())
 		{
 			roller_coaster.UpdateTrack(SEP_DIST, MIN_V, DEC_FRAC, imgui_panel::look_ahead);
+			upload_frames();
 			imgui_panel::update_lookahead = false;
 		}
 
+		// re-place the track pieces and supports (after any edit has been swapped in, so it is not lost)
+		if (imgui_panel::update_spacing && !track_editor.editing())
+		{
+			roller_coaster.SetAdaptiveSpacing(imgui_panel::adaptive_spacing, imgui_panel::max_visual_error);
+			roller_coaster.RebuildTrack();
+			upload_frames();
+			imgui_panel::update_spacing = false;
+		}
+		imgui_panel::num_track_pieces = roller_coaster.pieceTransforms()->size();
+		imgui_panel::num_supports = roller_coaster.SupportTransforms()->size();
+
 		// allow the user to reset the simulation
 		if(imgui_panel::reset_simulation)
 		{
@@ -245,30 +493,24 @@ int main(void) {
 		}
 
 		
-		// place the track pieces
-		std::vector<glm::mat4>* piece_transforms = roller_coaster.pieceTransforms();
-		for(size_t i = 0; i < piece_transforms->size(); i++)
-		{
-			addInstance(track_piece_render, (*piece_transforms)[i]);
+		if (imgui_panel::swept_rails && rails_stale) {
+			gpu_rails.upload(modelling::sweepRails(roller_coaster.GetFrameCache(), &scheduler));
+			imgui_panel::rail_vertices = gpu_rails.vertexCount();
+			rails_stale = false;
 		}
 
-		// place the supports for the track
-		std::vector<glm::mat4> *sup_transforms = roller_coaster.SupportTransforms();
-		for (size_t i = 0; i < sup_transforms->size(); i++)
+		// place the track pieces, supports and trees (drawn straight from the roller coaster's arrays)
 		{
-			addInstance(sup_render, (*sup_transforms)[i]);
+			PROFILE_SCOPE("instance submission");
+			if (!imgui_panel::swept_rails)
+				setInstances(track_piece_render, *roller_coaster.pieceTransforms());
+			setInstances(sup_render, *roller_coaster.SupportTransforms());
+			setInstances(tree_render, *roller_coaster.TreeTransforms());
+
+			// place the ground
+			addInstance(ground_render, ground_transform);
 		}
 
-		// place the trees
-		std::vector<glm::mat4> *tree_transforms = roller_coaster.TreeTransforms();
-		for (size_t i = 0; i < tree_transforms->size(); i++)
-		{
-			addInstance(tree_render, (*tree_transforms)[i]);
-		}
-		
-		// place the ground
-		addInstance(ground_render, ground_transform);
-
 		// render
 		auto color = imgui_panel::clear_color;
 		glClearColor(color.x, color.y, color.z, color.z);
@@ -279,17 +521,32 @@ int main(void) {
 		// allow the curve to be hidden
 		if(imgui_panel::show_curve)
 		{
-			draw(cp_render, view);
-			draw(cp_t_render, view);
-			draw(track_render, view);
+			profiled_draw("draw control points", cp_render);
+			profiled_draw("draw tangents", cp_t_render);
+			if (imgui_panel::gpu_curve_sampling) {
+				PROFILE_GPU_SCOPE("draw curve");
+				gpu_curve.draw(view, imgui_panel::curveSamples, glm::vec3(0.2f, 0.7f, 1.0f));
+			}
+			else
+				profiled_draw("draw curve", track_render);
 		}
 
 		
-		draw(cart_renders, view);
-		draw(track_piece_render, view);
-		draw(ground_render, view);
-		draw(tree_render, view);
-		draw(sup_render, view);
+		if (imgui_panel::gpu_carts) {
+			PROFILE_GPU_SCOPE("draw carts");
+			gpu_carts.draw(view, cart_s.data(), cart_s.size());
+		}
+		else
+			profiled_draw("draw carts", cart_renders);
+		if (imgui_panel::swept_rails) {
+			PROFILE_GPU_SCOPE("draw rails");
+			gpu_rails.draw(view);
+		}
+		else
+			profiled_draw("draw track pieces", track_piece_render);
+		profiled_draw("draw ground", ground_render);
+		profiled_draw("draw trees", tree_render);
+		profiled_draw("draw supports", sup_render);
 	});
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
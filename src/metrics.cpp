@@ -0,0 +1,66 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "metrics.hpp"
+
+namespace metrics
+{
+    namespace
+    {
+        // the sinks are never freed so a task can still count into the sink of a thread that has exited
+        Sink &ownSink()
+        {
+            thread_local Sink *sink = new Sink();
+            return *sink;
+        }
+
+        thread_local Sink *tls_current = nullptr;
+    }
+
+    Snapshot Sink::snapshot() const
+    {
+        Snapshot total;
+        for (size_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            total.values[i] = m_values[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    Sink &threadSink()
+    {
+        return ownSink();
+    }
+
+    Sink &currentSink()
+    {
+        return tls_current ? *tls_current : ownSink();
+    }
+
+    ScopedSink::ScopedSink(Sink &sink) : m_previous(tls_current)
+    {
+        tls_current = &sink;
+    }
+
+    ScopedSink::~ScopedSink()
+    {
+        tls_current = m_previous;
+    }
+
+    const char *counterName(Counter counter)
+    {
+        switch (counter)
+        {
+        case CURVE_EVALUATIONS: return "Curve evaluations";
+        case TABLE_LOOKUPS: return "Table lookups";
+        case TRANSFORM_BUILDS: return "Transform builds";
+        case INSTANCE_UPLOADS: return "Instance uploads";
+        case BYTES_UPLOADED: return "Bytes uploaded";
+        case COUNTER_COUNT: break;
+        }
+        return "";
+    }
+}
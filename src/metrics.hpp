@@ -0,0 +1,126 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// counters are on in debug builds, release builds (NDEBUG) need ENABLE_METRICS=1
+#if !defined(ENABLE_METRICS) && !defined(NDEBUG)
+#define ENABLE_METRICS 1
+#endif
+
+#if defined(ENABLE_METRICS) && ENABLE_METRICS
+#define METRICS_ADD(counter, n) metrics::add(metrics::counter, uint64_t(n))
+#else
+#define METRICS_ADD(counter, n) ((void)0)
+#endif
+
+namespace metrics
+{
+    enum Counter
+    {
+        CURVE_EVALUATIONS, // Curve::operator()
+        TABLE_LOOKUPS,     // ArcLengthTable::operator()
+        TRANSFORM_BUILDS,  // transforms assembled for carts, track pieces and supports
+        INSTANCE_UPLOADS,  // instanced draws that upload per instance data
+        BYTES_UPLOADED,    // bytes of per instance data uploaded
+        COUNTER_COUNT
+    };
+
+    // the totals of every counter at one point in time
+    struct Snapshot
+    {
+        uint64_t values[COUNTER_COUNT] = {};
+
+        uint64_t operator[](Counter counter) const { return values[counter]; }
+
+        // the counts between two snapshots
+        Snapshot operator-(Snapshot const &earlier) const
+        {
+            Snapshot delta;
+            for (size_t i = 0; i < COUNTER_COUNT; i++)
+            {
+                delta.values[i] = values[i] - earlier.values[i];
+            }
+            return delta;
+        }
+
+        // add the counts of another interval (for work spread over several frames)
+        Snapshot &operator+=(Snapshot const &other)
+        {
+            for (size_t i = 0; i < COUNTER_COUNT; i++)
+            {
+                values[i] += other.values[i];
+            }
+            return *this;
+        }
+    };
+
+    // false when the counters are compiled out (every snapshot is zero)
+    constexpr bool enabled()
+    {
+#if defined(ENABLE_METRICS) && ENABLE_METRICS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * a block of counters that work is attributed to, every thread has its own and a rebuild can make one for the
+     * tasks it runs, so counts from other threads never leak into a frame or a rebuild
+     */
+    class Sink
+    {
+    public:
+        // several threads may share a sink (the tasks of one rebuild) so this is an atomic add
+        void add(Counter counter, uint64_t n)
+        {
+            m_values[counter].fetch_add(n, std::memory_order_relaxed);
+        }
+
+        // the totals so far (may miss increments that are in flight on other threads)
+        Snapshot snapshot() const;
+
+    private:
+        std::atomic<uint64_t> m_values[COUNTER_COUNT] = {};
+    };
+
+    // the calling thread's own sink, where its counts go when no scope is set
+    Sink &threadSink();
+
+    // where the calling thread's counts go right now, the task scheduler hands this on to the tasks it submits
+    Sink &currentSink();
+
+    /**
+     * sends the calling thread's counts to a sink until the scope ends
+     * the sink must outlive every task submitted inside the scope
+     */
+    class ScopedSink
+    {
+    public:
+        explicit ScopedSink(Sink &sink);
+        ~ScopedSink();
+
+        ScopedSink(const ScopedSink &) = delete;
+        ScopedSink &operator=(const ScopedSink &) = delete;
+
+    private:
+        Sink *m_previous;
+    };
+
+    // add to a counter of the current sink, use METRICS_ADD so the call compiles out
+    inline void add(Counter counter, uint64_t n)
+    {
+        currentSink().add(counter, n);
+    }
+
+    // a readable name for a counter
+    const char *counterName(Counter counter);
+}
@@ -0,0 +1,194 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "poisson_disk.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace modelling
+{
+    namespace
+    {
+        // mixes the seed and tile index so neighbouring tiles get unrelated generators
+        uint32_t tileSeed(uint32_t seed, size_t tile)
+        {
+            uint64_t z = (uint64_t(seed) << 32) + uint64_t(tile) + 0x9e3779b97f4a7c15ull;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return uint32_t(z ^ (z >> 31));
+        }
+
+        // the background grid, every cell holds at most one point
+        struct Grid
+        {
+            glm::vec2 lo;
+            glm::vec2 hi;
+            float cell;
+            int width;
+            int height;
+            std::vector<glm::vec2> points;
+            std::vector<char> used;
+
+            glm::ivec2 cellOf(glm::vec2 p) const
+            {
+                glm::ivec2 c = glm::ivec2(glm::floor((p - lo) / cell));
+                return glm::clamp(c, glm::ivec2(0), glm::ivec2(width - 1, height - 1));
+            }
+
+            // true if no point is within radius of p (a cell is smaller than the radius so 2 cells out is enough)
+            bool clear(glm::vec2 p, float radius2) const
+            {
+                glm::ivec2 c = cellOf(p);
+                for (int y = std::max(c.y - 2, 0); y <= std::min(c.y + 2, height - 1); y++)
+                {
+                    for (int x = std::max(c.x - 2, 0); x <= std::min(c.x + 2, width - 1); x++)
+                    {
+                        size_t i = size_t(y) * size_t(width) + size_t(x);
+                        if (used[i])
+                        {
+                            glm::vec2 d = points[i] - p;
+                            if (glm::dot(d, d) < radius2)
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+                return true;
+            }
+        };
+
+        /**
+         * Bridson's algorithm restricted to the cells [cell_lo, cell_hi) of one tile
+         * random starting points are thrown until POISSON_ATTEMPTS of them in a row fail, so regions cut off
+         * from each other (by rejected areas) still get filled
+         */
+        void sampleTile(Grid &grid, glm::ivec2 cell_lo, glm::ivec2 cell_hi, float radius, uint32_t seed,
+                        std::function<bool(glm::vec2)> const &reject, std::vector<glm::vec2> &out)
+        {
+            glm::vec2 lo = grid.lo + glm::vec2(cell_lo) * grid.cell;
+            glm::vec2 hi = glm::min(grid.lo + glm::vec2(cell_hi) * grid.cell, grid.hi);
+            float radius2 = radius * radius;
+
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+            auto valid = [&](glm::vec2 p) {
+                return p.x >= lo.x && p.y >= lo.y && p.x < hi.x && p.y < hi.y && grid.clear(p, radius2) && !reject(p);
+            };
+            std::vector<glm::vec2> active;
+            auto accept = [&](glm::vec2 p) {
+                glm::ivec2 c = grid.cellOf(p);
+                size_t i = size_t(c.y) * size_t(grid.width) + size_t(c.x);
+                grid.points[i] = p;
+                grid.used[i] = 1;
+                out.push_back(p);
+                active.push_back(p);
+            };
+
+            int failures = 0;
+            while (failures < POISSON_ATTEMPTS)
+            {
+                glm::vec2 start = lo + glm::vec2(unit(gen), unit(gen)) * (hi - lo);
+                if (!valid(start))
+                {
+                    failures++;
+                    continue;
+                }
+                failures = 0;
+                accept(start);
+
+                // grow from a random active point, retire it once it has no room left around it
+                while (!active.empty())
+                {
+                    size_t index = size_t(unit(gen) * float(active.size())) % active.size();
+                    glm::vec2 a = active[index];
+                    bool found = false;
+                    for (int k = 0; k < POISSON_ATTEMPTS && !found; k++)
+                    {
+                        float angle = 2.0f * float(M_PI) * unit(gen);
+                        float distance = radius * (1.0f + unit(gen));
+                        glm::vec2 candidate = a + distance * glm::vec2(std::cos(angle), std::sin(angle));
+                        if (valid(candidate))
+                        {
+                            accept(candidate);
+                            found = true;
+                        }
+                    }
+                    if (!found)
+                    {
+                        active[index] = active.back();
+                        active.pop_back();
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<glm::vec2> poissonDiskSample(glm::vec2 lo, glm::vec2 hi, float radius, uint32_t seed,
+                                             std::function<bool(glm::vec2)> const &reject,
+                                             tasks::TaskScheduler *scheduler)
+    {
+        if (radius <= 0.0f || hi.x <= lo.x || hi.y <= lo.y)
+        {
+            return {};
+        }
+
+        Grid grid;
+        grid.lo = lo;
+        grid.hi = hi;
+        grid.cell = radius / std::sqrt(2.0f);
+        grid.width = std::max(int(std::ceil((hi.x - lo.x) / grid.cell)), 1);
+        grid.height = std::max(int(std::ceil((hi.y - lo.y) / grid.cell)), 1);
+        grid.points.resize(size_t(grid.width) * size_t(grid.height));
+        grid.used.assign(grid.points.size(), 0);
+
+        int tiles_x = (grid.width + POISSON_TILE_CELLS - 1) / POISSON_TILE_CELLS;
+        int tiles_y = (grid.height + POISSON_TILE_CELLS - 1) / POISSON_TILE_CELLS;
+        std::vector<std::vector<glm::vec2>> tile_points(size_t(tiles_x) * size_t(tiles_y));
+
+        // four passes, one per corner of a 2x2 block of tiles
+        std::vector<size_t> tiles;
+        for (int pass = 0; pass < 4; pass++)
+        {
+            tiles.clear();
+            for (int ty = pass / 2; ty < tiles_y; ty += 2)
+            {
+                for (int tx = pass % 2; tx < tiles_x; tx += 2)
+                {
+                    tiles.push_back(size_t(ty) * size_t(tiles_x) + size_t(tx));
+                }
+            }
+
+            auto run = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    size_t tile = tiles[i];
+                    glm::ivec2 t(int(tile % size_t(tiles_x)), int(tile / size_t(tiles_x)));
+                    glm::ivec2 cell_lo = t * POISSON_TILE_CELLS;
+                    glm::ivec2 cell_hi = glm::min(cell_lo + POISSON_TILE_CELLS, glm::ivec2(grid.width, grid.height));
+                    sampleTile(grid, cell_lo, cell_hi, radius, tileSeed(seed, tile), reject, tile_points[tile]);
+                }
+            };
+            if (scheduler)
+            {
+                scheduler->parallel_for(0, tiles.size(), 1, run);
+            }
+            else
+            {
+                run(0, tiles.size());
+            }
+        }
+
+        std::vector<glm::vec2> points;
+        for (std::vector<glm::vec2> const &tile : tile_points)
+        {
+            points.insert(points.end(), tile.begin(), tile.end());
+        }
+        return points;
+    }
+}
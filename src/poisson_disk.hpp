@@ -0,0 +1,37 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "task_scheduler.hpp"
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+// candidates tried around each active point before it is retired (Bridson's k)
+#define POISSON_ATTEMPTS 30
+// the side of a tile in grid cells, tiles are the unit of parallel work
+#define POISSON_TILE_CELLS 32
+
+namespace modelling
+{
+    /**
+     * Bridson's Poisson disk sampling (2007) over a rectangle: no two points are closer than radius.
+     * A background grid with cells of radius / sqrt(2) holds at most one point per cell, so a candidate only
+     * checks the 5x5 cells around it. The rectangle is cut into tiles that run in four passes of a 2x2
+     * colouring, tiles of one colour are a whole tile apart so they can run in parallel without sharing cells.
+     * Each tile has its own generator seeded from (seed, tile), so the result only depends on the seed.
+     * @param lo the lower corner
+     * @param hi the upper corner
+     * @param reject return true to throw away a candidate (it must be safe to call from several threads)
+     * @param scheduler runs the tiles in parallel, null to run them in order on the calling thread
+     * @return the points ordered by tile
+     */
+    std::vector<glm::vec2> poissonDiskSample(glm::vec2 lo, glm::vec2 hi, float radius, uint32_t seed,
+                                             std::function<bool(glm::vec2)> const &reject,
+                                             tasks::TaskScheduler *scheduler = nullptr);
+}
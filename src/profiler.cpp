@@ -0,0 +1,319 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "profiler.hpp"
+#include "givr.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace profiling
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start_time = Clock::now();
+
+        // everything is preallocated so profiling does not add heap allocations to the frame loop
+        struct State
+        {
+            std::mutex mutex;
+            std::array<Zone, ZONE_CAPACITY> zones;
+            size_t zone_count = 0; // total recorded, the ring index is zone_count % ZONE_CAPACITY
+            std::array<ZoneSummary, MAX_ZONE_NAMES> summaries;
+            size_t summary_count = 0;
+            size_t frame = 0;
+
+            std::array<float, FRAME_HISTORY> frame_ms{};
+            size_t frame_index = 0;
+            double last_frame_us = -1.0;
+        };
+
+        State &state()
+        {
+            static State s;
+            return s;
+        }
+
+        // small sequential ids are easier to read in a trace than hashed std::thread::ids
+        size_t threadIndex()
+        {
+            static std::atomic<size_t> next{0};
+            thread_local size_t index = next++;
+            return index;
+        }
+
+        ZoneSummary *summaryFor(State &s, const char *name, bool gpu)
+        {
+            for (size_t i = 0; i < s.summary_count; i++)
+            {
+                if (s.summaries[i].gpu == gpu && (s.summaries[i].name == name || std::strcmp(s.summaries[i].name, name) == 0))
+                {
+                    return &s.summaries[i];
+                }
+            }
+            if (s.summary_count == MAX_ZONE_NAMES)
+            {
+                return nullptr;
+            }
+            s.summaries[s.summary_count] = ZoneSummary{name, gpu, 0.0f, 0.0f, 0.0f};
+            return &s.summaries[s.summary_count++];
+        }
+
+        // a pair of timestamp queries, only touched on the render thread
+        struct GpuQuery
+        {
+            GLuint begin = 0;
+            GLuint end = 0;
+            const char *name = nullptr;
+            bool pending = false;
+        };
+
+        struct GpuState
+        {
+            std::array<GpuQuery, GPU_QUERY_PAIRS> queries;
+            size_t next = 0;
+            bool initialized = false;
+            // maps GL timestamps (ns) onto the CPU clock (us)
+            double offset_us = 0.0;
+        };
+
+        GpuState &gpuState()
+        {
+            static GpuState g;
+            return g;
+        }
+
+        void initializeGpu(GpuState &g)
+        {
+            for (GpuQuery &q : g.queries)
+            {
+                glGenQueries(1, &q.begin);
+                glGenQueries(1, &q.end);
+            }
+            GLint64 gpu_now = 0;
+            glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+            g.offset_us = nowUs() - double(gpu_now) / 1000.0;
+            g.initialized = true;
+        }
+
+        void collectGpuQueries()
+        {
+            GpuState &g = gpuState();
+            for (GpuQuery &q : g.queries)
+            {
+                if (!q.pending)
+                {
+                    continue;
+                }
+                GLint available = 0;
+                glGetQueryObjectiv(q.end, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available)
+                {
+                    continue;
+                }
+                GLuint64 begin = 0, end = 0;
+                glGetQueryObjectui64v(q.begin, GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(q.end, GL_QUERY_RESULT, &end);
+                recordZone(q.name, double(begin) / 1000.0 + g.offset_us, double(end - begin) / 1000.0, true);
+                q.pending = false;
+            }
+        }
+
+        // writes a string with the characters JSON needs escaped
+        void writeJsonString(std::FILE *file, const char *str)
+        {
+            std::fputc('"', file);
+            for (const char *c = str; *c; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    std::fputc('\\', file);
+                }
+                std::fputc(*c, file);
+            }
+            std::fputc('"', file);
+        }
+    }
+
+    double nowUs()
+    {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start_time).count();
+    }
+
+    void recordZone(const char *name, double start_us, double duration_us, bool gpu)
+    {
+        State &s = state();
+        size_t thread = gpu ? GPU_THREAD : threadIndex();
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.zones[s.zone_count % ZONE_CAPACITY] = Zone{name, start_us, duration_us, thread, s.frame};
+        s.zone_count++;
+
+        ZoneSummary *summary = summaryFor(s, name, gpu);
+        if (summary)
+        {
+            float ms = float(duration_us / 1000.0);
+            summary->last_ms = ms;
+            // exponential moving average so one slow frame does not hide the trend
+            summary->average_ms = summary->average_ms == 0.0f ? ms : 0.9f * summary->average_ms + 0.1f * ms;
+            summary->max_ms = std::max(summary->max_ms, ms);
+        }
+    }
+
+    void newFrame()
+    {
+        State &s = state();
+        double now = nowUs();
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.last_frame_us >= 0.0)
+            {
+                s.frame_ms[s.frame_index % FRAME_HISTORY] = float((now - s.last_frame_us) / 1000.0);
+                s.frame_index++;
+            }
+            s.last_frame_us = now;
+            s.frame++;
+        }
+
+        if (gpuState().initialized)
+        {
+            collectGpuQueries();
+        }
+    }
+
+    FrameStats frameStats()
+    {
+        State &s = state();
+        std::array<float, FRAME_HISTORY> sorted;
+        size_t n;
+        FrameStats stats{0.0f, 0.0f, 0.0f, 0.0f};
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            n = std::min(s.frame_index, FRAME_HISTORY);
+            if (n == 0)
+            {
+                return stats;
+            }
+            std::copy(s.frame_ms.begin(), s.frame_ms.begin() + n, sorted.begin());
+            stats.last_ms = s.frame_ms[(s.frame_index - 1) % FRAME_HISTORY];
+        }
+
+        std::sort(sorted.begin(), sorted.begin() + n);
+        auto percentile = [&](float p) { return sorted[std::min(n - 1, size_t(p * float(n)))]; };
+        stats.p50_ms = percentile(0.50f);
+        stats.p99_ms = percentile(0.99f);
+        stats.max_ms = sorted[n - 1];
+        return stats;
+    }
+
+    size_t copyFrameTimes(float *out, size_t capacity)
+    {
+        State &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        // the ring starts at the oldest frame once it has wrapped
+        size_t offset = s.frame_index % FRAME_HISTORY;
+        size_t count = std::min(capacity, FRAME_HISTORY);
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = s.frame_ms[(offset + i) % FRAME_HISTORY];
+        }
+        return count;
+    }
+
+    void frameTimeHistogram(float *bins, size_t count, float min_ms, float max_ms)
+    {
+        State &s = state();
+        std::fill(bins, bins + count, 0.0f);
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        size_t n = std::min(s.frame_index, FRAME_HISTORY);
+        float width = (max_ms - min_ms) / float(count);
+        for (size_t i = 0; i < n; i++)
+        {
+            float bin = (s.frame_ms[i] - min_ms) / width;
+            bins[size_t(std::clamp(bin, 0.0f, float(count - 1)))] += 1.0f;
+        }
+    }
+
+    size_t copyZoneSummaries(ZoneSummary *out, size_t capacity)
+    {
+        State &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        size_t count = std::min(s.summary_count, capacity);
+        std::copy(s.summaries.begin(), s.summaries.begin() + count, out);
+        return count;
+    }
+
+    bool exportChromeTrace(std::string const &file_path)
+    {
+        std::FILE *file = std::fopen(file_path.c_str(), "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "Unable to write trace %s\n", file_path.c_str());
+            return false;
+        }
+
+        State &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        // complete ("X") events, GPU zones get their own lane
+        std::fputs("{\"traceEvents\":[\n", file);
+        size_t count = std::min(s.zone_count, ZONE_CAPACITY);
+        size_t first = s.zone_count - count;
+        for (size_t i = first; i < s.zone_count; i++)
+        {
+            Zone const &z = s.zones[i % ZONE_CAPACITY];
+            std::fputs("{\"name\":", file);
+            writeJsonString(file, z.name);
+            std::fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu,\"args\":{\"frame\":%zu}}%s\n",
+                         z.thread == GPU_THREAD ? "gpu" : "cpu", z.start_us, z.duration_us,
+                         z.thread == GPU_THREAD ? size_t(1000) : z.thread, z.frame, i + 1 < s.zone_count ? "," : "");
+        }
+        std::fputs("],\n\"displayTimeUnit\":\"ms\"}\n", file);
+        std::fclose(file);
+        return true;
+    }
+
+    ScopedGpuTimer::ScopedGpuTimer(const char *name) : m_cpu(name), m_query(GPU_QUERY_PAIRS)
+    {
+        GpuState &g = gpuState();
+        if (!g.initialized)
+        {
+            initializeGpu(g);
+        }
+
+        // skip the GPU side when every pair is still waiting on the GPU
+        for (size_t i = 0; i < GPU_QUERY_PAIRS; i++)
+        {
+            size_t index = (g.next + i) % GPU_QUERY_PAIRS;
+            if (!g.queries[index].pending)
+            {
+                m_query = index;
+                g.next = index + 1;
+                break;
+            }
+        }
+        if (m_query < GPU_QUERY_PAIRS)
+        {
+            g.queries[m_query].name = name;
+            glQueryCounter(g.queries[m_query].begin, GL_TIMESTAMP);
+        }
+    }
+
+    ScopedGpuTimer::~ScopedGpuTimer()
+    {
+        if (m_query < GPU_QUERY_PAIRS)
+        {
+            GpuQuery &q = gpuState().queries[m_query];
+            glQueryCounter(q.end, GL_TIMESTAMP);
+            q.pending = true;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// time the rest of the enclosing scope on the CPU (name must be a string literal or otherwise outlive the profiler)
+#define PROFILE_SCOPE(name) profiling::ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+
+// time the rest of the enclosing scope on the CPU and the GL commands it issues on the GPU (render thread only)
+#define PROFILE_GPU_SCOPE(name) profiling::ScopedGpuTimer PROFILE_CONCAT(profile_gpu_scope_, __LINE__)(name)
+
+namespace profiling
+{
+    // the number of frame times kept for the statistics and plots
+    constexpr size_t FRAME_HISTORY = 240;
+    // the number of zones kept for the trace export (the oldest are overwritten)
+    constexpr size_t ZONE_CAPACITY = 16384;
+    // the number of distinct zone names tracked in the summary
+    constexpr size_t MAX_ZONE_NAMES = 64;
+    // the number of GL timer query pairs in flight
+    constexpr size_t GPU_QUERY_PAIRS = 64;
+
+    // one timed region
+    struct Zone
+    {
+        const char *name;
+        double start_us; // since the profiler started
+        double duration_us;
+        size_t thread; // small id per thread, GPU_THREAD for GPU zones
+        size_t frame;
+    };
+
+    constexpr size_t GPU_THREAD = ~size_t(0);
+
+    // the latest and smoothed duration of every zone with the same name
+    struct ZoneSummary
+    {
+        const char *name;
+        bool gpu;
+        float last_ms;
+        float average_ms;
+        float max_ms;
+    };
+
+    struct FrameStats
+    {
+        float last_ms;
+        float p50_ms;
+        float p99_ms;
+        float max_ms;
+    };
+
+    /**
+     * mark the start of a frame (call once per frame on the render thread)
+     * records the time since the previous call as the frame time and collects finished GPU queries
+     */
+    void newFrame();
+
+    // statistics over the last FRAME_HISTORY frames
+    FrameStats frameStats();
+
+    /**
+     * copy the frame time history in ms, oldest first (newFrame writes it on the render thread so it is copied under the lock)
+     * @param out the destination, holds up to capacity values (FRAME_HISTORY for the whole history)
+     * @return the number of values copied
+     */
+    size_t copyFrameTimes(float *out, size_t capacity);
+
+    /**
+     * bins the frame time history into a histogram
+     * @param bins the destination, count values
+     * @param min_ms the lower bound of the first bin
+     * @param max_ms the upper bound of the last bin (larger times go into the last bin)
+     */
+    void frameTimeHistogram(float *bins, size_t count, float min_ms, float max_ms);
+
+    /**
+     * copy the summaries of every zone seen so far (zones are recorded from any thread so they are copied under the lock)
+     * @param out the destination, holds up to capacity summaries
+     * @return the number of summaries copied
+     */
+    size_t copyZoneSummaries(ZoneSummary *out, size_t capacity);
+
+    /**
+     * write the recorded zones as Chrome trace JSON (load it in chrome://tracing or Perfetto)
+     * @return false if the file could not be written
+     */
+    bool exportChromeTrace(std::string const &file_path);
+
+    // record a finished zone (the timers call this)
+    void recordZone(const char *name, double start_us, double duration_us, bool gpu);
+
+    // microseconds since the profiler started
+    double nowUs();
+
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const char *name) : m_name(name), m_start(nowUs()) {}
+        ~ScopedTimer() { recordZone(m_name, m_start, nowUs() - m_start, false); }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        const char *m_name;
+        double m_start;
+    };
+
+    /**
+     * a CPU zone plus a pair of GL timestamp queries around the same scope
+     * the GPU duration is read back a few frames later (in newFrame) so the CPU never waits on the GPU
+     */
+    class ScopedGpuTimer
+    {
+    public:
+        explicit ScopedGpuTimer(const char *name);
+        ~ScopedGpuTimer();
+
+        ScopedGpuTimer(const ScopedGpuTimer &) = delete;
+        ScopedGpuTimer &operator=(const ScopedGpuTimer &) = delete;
+
+    private:
+        ScopedTimer m_cpu;
+        size_t m_query;
+    };
+}
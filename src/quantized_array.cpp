@@ -0,0 +1,76 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "quantized_array.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace modelling
+{
+    template <size_t Overlap>
+    void QuantizedArray<Overlap>::reserve(size_t n)
+    {
+        size_t blocks = (n + QUANTIZED_BLOCK - 1) / QUANTIZED_BLOCK;
+        m_offsets.reserve(n + blocks * Overlap);
+        m_blocks.reserve(blocks);
+    }
+
+    template <size_t Overlap>
+    void QuantizedArray<Overlap>::push_back(float value)
+    {
+        m_pending[m_num_pending++] = value;
+        m_size++;
+        if (m_num_pending == QUANTIZED_BLOCK + Overlap)
+        {
+            encodePending();
+            // the values past the block are also the first values of the next block
+            std::copy(m_pending + QUANTIZED_BLOCK, m_pending + QUANTIZED_BLOCK + Overlap, m_pending);
+            m_num_pending = Overlap;
+        }
+    }
+
+    template <size_t Overlap>
+    void QuantizedArray<Overlap>::finish()
+    {
+        // carried over values still get their own block, value i is always looked up in block i / QUANTIZED_BLOCK
+        if (m_num_pending > 0)
+        {
+            encodePending();
+        }
+        m_num_pending = 0;
+    }
+
+    template <size_t Overlap>
+    size_t QuantizedArray<Overlap>::size() const
+    {
+        return m_size;
+    }
+
+    template <size_t Overlap>
+    size_t QuantizedArray<Overlap>::bytes() const
+    {
+        return m_blocks.size() * sizeof(Block) + m_offsets.size() * sizeof(uint16_t);
+    }
+
+    template <size_t Overlap>
+    void QuantizedArray<Overlap>::encodePending()
+    {
+        auto range = std::minmax_element(m_pending, m_pending + m_num_pending);
+        Block block{*range.first, (*range.second - *range.first) / 65535.0f};
+        m_blocks.push_back(block);
+
+        // a flat block has no steps, every offset is 0
+        float inv_scale = block.scale > 0.0f ? 1.0f / block.scale : 0.0f;
+        for (size_t i = 0; i < m_num_pending; i++)
+        {
+            float level = std::round((m_pending[i] - block.base) * inv_scale);
+            m_offsets.push_back(uint16_t(std::min(level, 65535.0f)));
+        }
+    }
+
+    template class QuantizedArray<1>;
+    template class QuantizedArray<3>;
+}
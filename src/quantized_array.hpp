@@ -0,0 +1,93 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// the number of values sharing one base and scale
+#define QUANTIZED_BLOCK 64
+
+namespace modelling
+{
+    /**
+     * An append only array of floats stored as 16 bit offsets from a per block base, for slowly varying tables
+     * like the arc length table. Each block of QUANTIZED_BLOCK values keeps its minimum and the step between
+     * quantization levels, so a value is off by at most half of (block max - block min) / 65535.
+     * Each block also keeps the first Overlap values of the next block, so a value and the Overlap after it always
+     * come from the same block and decode with a single block lookup and no branches (block i / QUANTIZED_BLOCK,
+     * offset i + block * Overlap). Values are staged until their block is full, call finish before reading.
+     */
+    template <size_t Overlap = 1>
+    class QuantizedArray
+    {
+    public:
+        static_assert(Overlap > 0, "lerp reads the value after i");
+
+        // the encoded values i to i + Overlap: value i + k is base + scale * offsets[k]
+        struct Run
+        {
+            float base;
+            float scale;
+            uint16_t const *offsets;
+        };
+
+        void reserve(size_t n);
+        void push_back(float value);
+        // quantize the last partly filled block
+        void finish();
+
+        size_t size() const;
+        // the bytes held by the encoded values
+        size_t bytes() const;
+
+        float operator[](size_t i) const
+        {
+            size_t block = i / QUANTIZED_BLOCK;
+            size_t offset = i + block * Overlap; // every earlier block repeats Overlap values
+            return m_blocks[block].base + m_blocks[block].scale * float(m_offsets[offset]);
+        }
+
+        // value i lerped towards value i + 1 (which must exist) by t
+        float lerp(size_t i, float t) const
+        {
+            size_t block = i / QUANTIZED_BLOCK;
+            size_t offset = i + block * Overlap;
+            float a = float(m_offsets[offset]);
+            float b = float(m_offsets[offset + 1]);
+            return m_blocks[block].base + m_blocks[block].scale * (a + (b - a) * t);
+        }
+
+        // values i to i + Overlap (which must exist) still encoded, for working on the offsets and decoding once
+        Run run(size_t i) const
+        {
+            size_t block = i / QUANTIZED_BLOCK;
+            return Run{m_blocks[block].base, m_blocks[block].scale, &m_offsets[i + block * Overlap]};
+        }
+
+    private:
+        struct Block
+        {
+            float base;
+            float scale;
+        };
+        std::vector<Block> m_blocks;
+        std::vector<uint16_t> m_offsets;
+        size_t m_size = 0;
+
+        // the values of the block being filled and the first values of the next one
+        float m_pending[QUANTIZED_BLOCK + Overlap];
+        size_t m_num_pending = 0;
+
+        void encodePending();
+    };
+
+    // the s -> U values of the arc length table and its padded segment start lengths
+    extern template class QuantizedArray<1>;
+    extern template class QuantizedArray<3>;
+}
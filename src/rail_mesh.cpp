@@ -0,0 +1,126 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "rail_mesh.hpp"
+#include "RollerCoaster.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace modelling
+{
+    namespace
+    {
+        // a tube of the cross section, in the frame's (B, N) plane before TRACK_SCALE
+        struct Tube
+        {
+            glm::vec2 centre;
+            float radius;
+        };
+
+        // the two rails line up with the rails of track_piece.obj, the spine runs under the ties
+        const Tube tubes[] = {
+            {glm::vec2(-0.9f, -0.07f), 0.1f},
+            {glm::vec2(0.9f, -0.07f), 0.1f},
+            {glm::vec2(0.0f, -0.45f), 0.15f},
+        };
+        constexpr size_t NUM_TUBES = sizeof(tubes) / sizeof(tubes[0]);
+        constexpr size_t RING_VERTICES = NUM_TUBES * RAIL_SIDES;
+        constexpr size_t RING_INDICES = RING_VERTICES * 6;
+
+        // the angle a rotation turns through
+        float angleBetween(glm::quat const &a, glm::quat const &b)
+        {
+            return 2.0f * std::acos(std::min(std::abs(glm::dot(a, b)), 1.0f));
+        }
+    }
+
+    RailMesh sweepRails(FrameCache const &frames, tasks::TaskScheduler *scheduler)
+    {
+        PROFILE_SCOPE("sweepRails");
+        RailMesh mesh;
+        size_t n = frames.size();
+        if (n < 2)
+        {
+            return mesh;
+        }
+
+        // pick the grid points that get a ring
+        float ds = frames.deltaS();
+        std::vector<size_t> ring_points{0};
+        glm::quat previous = frames.orientation(0.0f);
+        float turned = 0.0f;
+        float travelled = 0.0f;
+        for (size_t i = 1; i < n; i++)
+        {
+            glm::quat q = frames.orientation(float(i) * ds);
+            turned += angleBetween(previous, q);
+            travelled += ds;
+            previous = q;
+            if (turned >= RAIL_MAX_ANGLE || travelled >= RAIL_MAX_SPACING)
+            {
+                ring_points.push_back(i);
+                turned = 0.0f;
+                travelled = 0.0f;
+            }
+        }
+
+        size_t rings = ring_points.size();
+        mesh.rings = rings;
+        mesh.positions.resize(rings * RING_VERTICES);
+        mesh.normals.resize(rings * RING_VERTICES);
+        mesh.indices.resize(rings * RING_INDICES);
+
+        // the unit circle of a tube
+        glm::vec2 circle[RAIL_SIDES];
+        for (size_t k = 0; k < RAIL_SIDES; k++)
+        {
+            float angle = 2.0f * float(M_PI) * float(k) / float(RAIL_SIDES);
+            circle[k] = glm::vec2(std::cos(angle), std::sin(angle));
+        }
+
+        // ring r writes its vertices and the quads joining it to ring r + 1 (the last ring joins ring 0)
+        auto build = [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; r++)
+            {
+                FrameCache::Frame f = frames(float(ring_points[r]) * ds);
+                glm::vec3 B = f.orientation * glm::vec3(1.0f, 0.0f, 0.0f);
+                glm::vec3 N = f.orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+
+                uint32_t base = uint32_t(r * RING_VERTICES);
+                uint32_t next = uint32_t(((r + 1) % rings) * RING_VERTICES);
+                uint32_t *index = &mesh.indices[r * RING_INDICES];
+                for (size_t t = 0; t < NUM_TUBES; t++)
+                {
+                    for (size_t k = 0; k < RAIL_SIDES; k++)
+                    {
+                        glm::vec3 normal = circle[k].x * B + circle[k].y * N;
+                        glm::vec2 local = TRACK_SCALE * (tubes[t].centre + tubes[t].radius * circle[k]);
+                        size_t v = base + t * RAIL_SIDES + k;
+                        mesh.positions[v] = f.position + local.x * B + local.y * N;
+                        mesh.normals[v] = normal;
+
+                        uint32_t a = uint32_t(t * RAIL_SIDES + k);
+                        uint32_t b = uint32_t(t * RAIL_SIDES + (k + 1) % RAIL_SIDES);
+                        // counter clockwise seen from outside the tube (the frame's z axis is the tangent)
+                        uint32_t quad[6] = {base + a, next + b, next + a, base + a, base + b, next + b};
+                        std::copy(quad, quad + 6, index);
+                        index += 6;
+                    }
+                }
+            }
+        };
+        if (scheduler)
+        {
+            scheduler->parallel_for(0, rings, RAIL_CHUNK_RINGS, build);
+        }
+        else
+        {
+            build(0, rings);
+        }
+        return mesh;
+    }
+}
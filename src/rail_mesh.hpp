@@ -0,0 +1,44 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "frame_cache.hpp"
+#include "task_scheduler.hpp"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// the number of vertices around each tube of the cross section
+#define RAIL_SIDES 8
+// a new ring is placed once the frame has turned (bent, twisted or banked) this many radians since the last one
+#define RAIL_MAX_ANGLE 0.05f
+// the longest gap between rings on straight track
+#define RAIL_MAX_SPACING 4.0f
+// rings per parallel chunk
+#define RAIL_CHUNK_RINGS 256
+
+namespace modelling
+{
+    // an indexed triangle mesh of the whole track
+    struct RailMesh
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<uint32_t> indices;
+        size_t rings = 0;
+    };
+
+    /**
+     * Sweeps the track cross section (two rails and a spine, sized like track_piece.obj) along the frame cache.
+     * Rings are put on frame cache grid points: walking the grid, the angle between neighbouring frames is summed
+     * and a ring is placed when it passes RAIL_MAX_ANGLE (or after RAIL_MAX_SPACING of straight track), so tight
+     * turns and rolls get dense rings and straights get few. The last ring joins the first, so the closed track
+     * has no seam. The rings are filled in parallel chunks, each ring owns a fixed run of vertices and indices.
+     * @param scheduler fills the chunks in parallel, null to fill them on the calling thread
+     */
+    RailMesh sweepRails(FrameCache const &frames, tasks::TaskScheduler *scheduler = nullptr);
+}
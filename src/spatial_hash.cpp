@@ -0,0 +1,40 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "spatial_hash.hpp"
+
+namespace modelling
+{
+    SpatialHash::SpatialHash(std::vector<glm::vec3> const &points, float cell_size)
+        : m_inv_cell(1.0f / cell_size)
+    {
+        // about half the buckets stay empty, which keeps the chains short
+        size_t table_size = 1;
+        while (table_size < 2 * points.size())
+        {
+            table_size <<= 1;
+        }
+        m_mask = table_size - 1;
+
+        std::vector<uint32_t> keys(points.size());
+        m_starts.assign(table_size + 1, 0);
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            keys[i] = bucket(cellOf(points[i]));
+            m_starts[keys[i] + 1]++;
+        }
+        for (size_t b = 0; b < table_size; b++)
+        {
+            m_starts[b + 1] += m_starts[b];
+        }
+        m_items.resize(points.size());
+        std::vector<uint32_t> fill(m_starts.begin(), m_starts.end() - 1);
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            m_items[fill[keys[i]]++] = uint32_t(i);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace modelling
+{
+    /**
+     * A uniform grid hashed into a fixed table, built with a counting sort so each bucket is one contiguous
+     * run of point indices (different cells can share a bucket, callers test the real distance).
+     * Built once over a fixed set of points, queries are read only so any number of threads can run them.
+     */
+    class SpatialHash
+    {
+    public:
+        SpatialHash() = default;
+
+        /**
+         * @param points the points to index (only the indices are stored, keep the points around)
+         * @param cell_size the grid spacing, queries find everything within one cell of the query point
+         */
+        SpatialHash(std::vector<glm::vec3> const &points, float cell_size);
+
+        // calls fn(index) for every point in the 27 cells around p (no further than one cell away)
+        template <typename Fn>
+        void forEachNear(glm::vec3 const &p, Fn fn) const
+        {
+            if (m_items.empty())
+            {
+                return;
+            }
+            glm::ivec3 c = cellOf(p);
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dz = -1; dz <= 1; dz++)
+                    {
+                        uint32_t b = bucket(c + glm::ivec3(dx, dy, dz));
+                        for (uint32_t k = m_starts[b]; k < m_starts[b + 1]; k++)
+                        {
+                            fn(m_items[k]);
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        float m_inv_cell = 1.0f;
+        size_t m_mask = 0;
+        std::vector<uint32_t> m_starts; // bucket b holds m_items[m_starts[b], m_starts[b + 1])
+        std::vector<uint32_t> m_items;
+
+        glm::ivec3 cellOf(glm::vec3 const &p) const
+        {
+            return glm::ivec3(glm::floor(p * m_inv_cell));
+        }
+
+        uint32_t bucket(glm::ivec3 const &c) const
+        {
+            // the usual large primes for spatial hashing (Teschner et al. 2003)
+            uint32_t h = (uint32_t(c.x) * 73856093u) ^ (uint32_t(c.y) * 19349663u) ^ (uint32_t(c.z) * 83492791u);
+            return uint32_t(h & m_mask);
+        }
+    };
+}
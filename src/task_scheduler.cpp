@@ -0,0 +1,305 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "task_scheduler.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace tasks
+{
+    struct TaskScheduler::Task
+    {
+        const char *name = nullptr;
+        std::function<void()> fn;
+        // the submitter's metrics sink, so the task's counts go to whoever asked for the work
+        metrics::Sink *metrics_sink = nullptr;
+        // unfinished dependencies, plus one held by submit until the task is fully registered
+        std::atomic<int> remaining{1};
+        std::atomic<bool> finished{false};
+
+        std::mutex mutex;
+        bool done = false; // guarded by mutex, set before the dependents are released
+        std::vector<TaskHandle> dependents;
+    };
+
+    namespace
+    {
+        // lets a worker thread find its own queue
+        thread_local const TaskScheduler *tls_scheduler = nullptr;
+        thread_local size_t tls_worker = 0;
+    }
+
+    TaskScheduler::TaskScheduler(size_t num_workers)
+    {
+        for (size_t i = 0; i < num_workers; i++)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+        // start the threads once every queue exists, workers steal from all of them
+        for (size_t i = 0; i < num_workers; i++)
+        {
+            m_workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+        }
+    }
+
+    TaskScheduler::~TaskScheduler()
+    {
+        // let the queued work drain before stopping
+        while (m_pending > 0 && tryRunOne())
+        {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stop = true;
+        }
+        m_sleep.notify_all();
+
+        for (auto &worker : m_workers)
+        {
+            worker->thread.join();
+        }
+    }
+
+    size_t TaskScheduler::defaultWorkerCount()
+    {
+        size_t n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 1;
+    }
+
+    size_t TaskScheduler::workerCount() const
+    {
+        return m_workers.size();
+    }
+
+    size_t TaskScheduler::currentWorker() const
+    {
+        return tls_scheduler == this ? tls_worker : m_workers.size();
+    }
+
+    TaskScheduler::TaskHandle TaskScheduler::submit(const char *name, std::function<void()> fn, std::initializer_list<TaskHandle> dependencies)
+    {
+        TaskHandle task = std::make_shared<Task>();
+        task->name = name;
+        task->fn = std::move(fn);
+        task->metrics_sink = &metrics::currentSink();
+
+        for (TaskHandle const &dependency : dependencies)
+        {
+            if (!dependency)
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(dependency->mutex);
+            if (!dependency->done)
+            {
+                task->remaining++;
+                dependency->dependents.push_back(task);
+            }
+        }
+
+        // drop the registration count, the task is ready now if every dependency had already finished
+        if (--task->remaining == 0)
+        {
+            enqueue(task);
+        }
+        return task;
+    }
+
+    void TaskScheduler::enqueue(TaskHandle task)
+    {
+        if (m_workers.empty())
+        {
+            // no pool, run it straight away on the submitting thread
+            run(task);
+            return;
+        }
+
+        size_t index = currentWorker();
+        if (index == m_workers.size())
+        {
+            index = m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+            m_workers[index]->queue.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_pending++;
+        }
+        m_sleep.notify_one();
+    }
+
+    bool TaskScheduler::tryRunOne()
+    {
+        size_t n = m_workers.size();
+        if (n == 0)
+        {
+            return false;
+        }
+
+        size_t self = currentWorker();
+        TaskHandle task;
+
+        // newest work from our own queue first (it is still warm in the cache)
+        if (self < n)
+        {
+            std::lock_guard<std::mutex> lock(m_workers[self]->mutex);
+            if (!m_workers[self]->queue.empty())
+            {
+                task = std::move(m_workers[self]->queue.back());
+                m_workers[self]->queue.pop_back();
+            }
+        }
+
+        // otherwise steal the oldest work from someone else
+        for (size_t k = 0; !task && k < n; k++)
+        {
+            size_t victim = (self + 1 + k) % n;
+            std::lock_guard<std::mutex> lock(m_workers[victim]->mutex);
+            if (!m_workers[victim]->queue.empty())
+            {
+                task = std::move(m_workers[victim]->queue.front());
+                m_workers[victim]->queue.pop_front();
+            }
+        }
+
+        if (!task)
+        {
+            return false;
+        }
+        m_pending--;
+        run(task);
+        return true;
+    }
+
+    void TaskScheduler::run(TaskHandle const &task)
+    {
+        auto start = std::chrono::steady_clock::now();
+        {
+            metrics::ScopedSink metrics_scope(*task->metrics_sink);
+            task->fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        if (task->name)
+        {
+            float ms = std::chrono::duration<float, std::milli>(end - start).count();
+            std::lock_guard<std::mutex> lock(m_timing_mutex);
+            m_timings.push_back({task->name, ms, currentWorker()});
+        }
+
+        std::vector<TaskHandle> dependents;
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->done = true;
+            dependents.swap(task->dependents);
+        }
+
+        // wake anyone waiting on this task
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            task->finished = true;
+        }
+        m_sleep.notify_all();
+
+        for (TaskHandle &dependent : dependents)
+        {
+            if (--dependent->remaining == 0)
+            {
+                enqueue(std::move(dependent));
+            }
+        }
+    }
+
+    void TaskScheduler::wait(TaskHandle const &task)
+    {
+        if (!task)
+        {
+            return;
+        }
+        while (!task->finished)
+        {
+            // help out instead of blocking
+            if (tryRunOne())
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleep.wait(lock, [&]() { return task->finished || m_pending > 0; });
+        }
+    }
+
+    void TaskScheduler::parallel_for(size_t begin, size_t end, size_t grain, std::function<void(size_t, size_t)> const &fn)
+    {
+        if (end <= begin)
+        {
+            return;
+        }
+        grain = std::max(grain, size_t(1));
+        size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1 || m_workers.empty())
+        {
+            fn(begin, end);
+            return;
+        }
+
+        // every helper (and this thread) grabs chunks until there are none left
+        std::atomic<size_t> next_chunk{0};
+        auto body = [&]() {
+            for (size_t c = next_chunk++; c < chunks; c = next_chunk++)
+            {
+                size_t chunk_begin = begin + c * grain;
+                fn(chunk_begin, std::min(end, chunk_begin + grain));
+            }
+        };
+
+        size_t num_helpers = std::min(m_workers.size(), chunks - 1);
+        std::vector<TaskHandle> helpers;
+        helpers.reserve(num_helpers);
+        for (size_t i = 0; i < num_helpers; i++)
+        {
+            helpers.push_back(submit(nullptr, body));
+        }
+
+        body();
+
+        // the helpers reference this stack frame so they must all be done before returning
+        for (TaskHandle const &helper : helpers)
+        {
+            wait(helper);
+        }
+    }
+
+    void TaskScheduler::takeTimings(std::vector<TaskTiming> &out)
+    {
+        std::lock_guard<std::mutex> lock(m_timing_mutex);
+        out.swap(m_timings);
+        m_timings.clear();
+    }
+
+    void TaskScheduler::workerLoop(size_t index)
+    {
+        tls_scheduler = this;
+        tls_worker = index;
+
+        while (true)
+        {
+            if (tryRunOne())
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleep.wait(lock, [this]() { return m_stop || m_pending > 0; });
+            if (m_stop && m_pending == 0)
+            {
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tasks
+{
+    /**
+     * A small work stealing thread pool. Each worker has its own queue, takes new work from the back of it
+     * and steals from the front of the other queues when it runs dry.
+     * Tasks can depend on other tasks, and threads that wait on a task help run queued tasks in the meantime,
+     * so it is fine to wait (or parallel_for) from inside a task.
+     */
+    class TaskScheduler
+    {
+    public:
+        struct Task;
+        using TaskHandle = std::shared_ptr<Task>;
+
+        // how long a named task took to run
+        struct TaskTiming
+        {
+            const char *name;
+            float ms;
+            size_t thread; // the worker that ran it, workerCount() for a thread outside the pool
+        };
+
+        /**
+         * start the worker threads
+         * @param num_workers the number of worker threads, the threads that wait on tasks help as well
+         */
+        explicit TaskScheduler(size_t num_workers = defaultWorkerCount());
+
+        /**
+         * finish the queued tasks and stop the worker threads
+         */
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler &) = delete;
+        TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+        /**
+         * queue a task to run once all of its dependencies have finished
+         * @param name the name used for the timings (nullptr to not record it), must outlive the scheduler
+         * @param fn the work to do
+         * @param dependencies the tasks that must finish first (null handles are ignored)
+         */
+        TaskHandle submit(const char *name, std::function<void()> fn, std::initializer_list<TaskHandle> dependencies = {});
+
+        // wait for a task to finish (null handles are already finished), runs other tasks while waiting
+        void wait(TaskHandle const &task);
+
+        /**
+         * call fn(chunk_begin, chunk_end) over [begin, end) split into chunks of grain indices, in parallel
+         * the calling thread works on chunks as well and returns once every chunk is done
+         */
+        void parallel_for(size_t begin, size_t end, size_t grain, std::function<void(size_t, size_t)> const &fn);
+
+        size_t workerCount() const;
+
+        // moves the timings of the named tasks that finished since the last call into out
+        void takeTimings(std::vector<TaskTiming> &out);
+
+        // one worker per hardware thread, leaving one for the render thread
+        static size_t defaultWorkerCount();
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<TaskHandle> queue;
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<size_t> m_next_queue{0};
+
+        // sleeping workers and waiting threads park here
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_sleep;
+        std::atomic<size_t> m_pending{0};
+        bool m_stop = false;
+
+        std::mutex m_timing_mutex;
+        std::vector<TaskTiming> m_timings;
+
+        void workerLoop(size_t index);
+        void enqueue(TaskHandle task);
+        bool tryRunOne();
+        void run(TaskHandle const &task);
+
+        // the index of the calling thread if it is one of this scheduler's workers, workerCount() otherwise
+        size_t currentWorker() const;
+    };
+}
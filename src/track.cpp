@@ -9,7 +9,10 @@
 
 #include "track.hpp"
 #include "RollerCoaster.hpp"
+#include "transform_batch.hpp"
+#include "profiler.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 
 namespace modelling
 {
@@ -20,28 +23,60 @@ namespace modelling
 
     void Track::setupTrack(RollerCoaster* roller_coaster, float _s_dist, float h)
     {
+        PROFILE_SCOPE("setupTrack");
+
         // sudo code
         // find the number of pieces needed
         // step through each s position and calculate the position and rotation
         // add the position and rotation to the array
 
+        // loop through the distances to get the positions, each chunk builds its transform matrices in one pass
+        size_t num_pieces = beginTrack(roller_coaster, _s_dist);
+        roller_coaster->ParallelFor(num_pieces, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            buildPieces(roller_coaster, begin, end);
+        });
+    }
+
+    size_t Track::beginTrack(RollerCoaster const* roller_coaster, float _s_dist)
+    {
+        s_dist = _s_dist;
+        if (roller_coaster->AdaptiveSpacing())
+        {
+            roller_coaster->PlaceAdaptively(ADAPTIVE_MIN_SPACING * _s_dist, ADAPTIVE_MAX_SPACING * _s_dist, TRACK_SCALE, roller_coaster->MaxVisualError(), piece_s);
+            piece_transforms.resize(piece_s.size());
+            return piece_s.size();
+        }
+
         // set the number of track pieces that will fit on this track
+        piece_s.clear();
         size_t num_pieces = size_t(roller_coaster->ArcLength() / _s_dist) + 1;
-        piece_transforms = std::vector<glm::mat4>(num_pieces);
+        piece_transforms.resize(num_pieces);
+        return num_pieces;
+    }
 
-        // loop through the distances to get the positions
-        float s = 0;
-        for(size_t i = 0; i < num_pieces; i++)
-        {
-            // store the transform matrix
-            piece_transforms[i] = roller_coaster->GetTransformAtPosition(s);
+    void Track::buildPieces(RollerCoaster const* roller_coaster, size_t begin, size_t end)
+    {
+        // scratch for one batch of pieces
+        constexpr size_t BATCH = 64;
+        glm::vec3 positions[BATCH], tangents[BATCH], normals[BATCH];
 
-            // increment the s value
-            s = s + _s_dist;
+        for(size_t batch = begin; batch < end; batch += BATCH)
+        {
+            size_t count = std::min(BATCH, end - batch);
+            for(size_t j = 0; j < count; j++)
+            {
+                // gather the frame at this position
+                float s = piece_s.empty() ? float(batch + j) * s_dist : piece_s[batch + j];
+                FrameCache::Frame f = roller_coaster->GetFrameAtPosition(s);
+                positions[j] = f.position;
+                tangents[j] = f.orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+                normals[j] = f.orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+            assembleTransforms(count, positions, tangents, normals, glm::vec3(TRACK_SCALE), &piece_transforms[batch]);
         }
     }
 
-    std::vector<glm::mat4> * Track::pieceTransforms()
+    std::pmr::vector<glm::mat4> * Track::pieceTransforms()
     {
         return &piece_transforms;
     }
@@ -11,6 +11,7 @@
 
 #include "hermite_curve.hpp"
 #include "arc_length_parameterize.hpp"
+#include "frame_arena.hpp"
 #include <glm/glm.hpp>
 #include <vector>
 
@@ -36,13 +37,25 @@ namespace modelling
          */
         void setupTrack(RollerCoaster* roller_coaster, float _s_dist, float h);
 
+        /**
+         * size the transform array for a track (the first half of setupTrack), with adaptive spacing on the
+         * pieces are placed between _s_dist * ADAPTIVE_MIN_SPACING and _s_dist * ADAPTIVE_MAX_SPACING apart
+         * @return the number of track pieces
+         */
+        size_t beginTrack(RollerCoaster const* roller_coaster, float _s_dist);
+
+        // place the track pieces [begin, end), chunks can run in parallel (the second half of setupTrack)
+        void buildPieces(RollerCoaster const* roller_coaster, size_t begin, size_t end);
+
         // get a reference to the track piece transforms
-        std::vector<glm::mat4>* pieceTransforms();
+        std::pmr::vector<glm::mat4>* pieceTransforms();
 
     private:
         // the array of transforms for each to the track pieces
-        std::vector<glm::mat4> piece_transforms = std::vector<glm::mat4>(0);
+        std::pmr::vector<glm::mat4> piece_transforms{memory::rebuildResource()};
         // the distance between each piece
         float s_dist = 1.0;
+        // the s position of each piece when they are placed adaptively (empty when they are s_dist apart)
+        std::pmr::vector<float> piece_s{memory::rebuildResource()};
     };
 }
\ No newline at end of file
@@ -0,0 +1,183 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "track_editor.hpp"
+#include "profiler.hpp"
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+namespace modelling
+{
+    bool TrackEditor::pick(RollerCoaster const &roller_coaster, glm::vec3 origin, glm::vec3 direction)
+    {
+        CurveRayHit hit = roller_coaster.RaycastTrack(origin, direction, PICK_RADIUS);
+        if (!hit.hit)
+        {
+            return false;
+        }
+
+        // start from the live track unless an earlier edit is still being rebuilt
+        if (!m_editing)
+        {
+            m_curve = roller_coaster.GetCurve();
+            // only what the rebuild keeps, the rest is rebuilt from scratch anyway
+            m_staging = roller_coaster.StagingCopy();
+        }
+        m_editing = true;
+        m_dragging = true;
+
+        // the hit is on segment floor(U n), take the nearer of its two end points
+        // (from the edited curve, the live one still has the old positions while a rebuild runs)
+        CoasterCurve::ControlPoints const &cps = m_curve.controlPoints();
+        size_t n = cps.size();
+        size_t a = std::min(size_t(hit.U * float(n)), n - 1);
+        size_t b = (a + 1) % n;
+        m_selected = glm::length(cps[a].position - hit.position) <= glm::length(cps[b].position - hit.position) ? a : b;
+
+        m_plane_point = cps[m_selected].position;
+        m_plane_normal = glm::normalize(direction);
+        return true;
+    }
+
+    void TrackEditor::drag(glm::vec3 origin, glm::vec3 direction)
+    {
+        if (!m_dragging)
+        {
+            return;
+        }
+
+        // rays nearly parallel to the plane would throw the point far away
+        float facing = glm::dot(direction, m_plane_normal);
+        if (std::abs(facing) < 1e-4f * glm::length(direction))
+        {
+            return;
+        }
+        float t = glm::dot(m_plane_point - origin, m_plane_normal) / facing;
+        glm::vec3 position = origin + t * direction;
+
+        CoasterCurve::ControlPoints &cps = m_curve.controlPoints();
+        size_t n = cps.size();
+        cps[m_selected].position = position;
+        // the Catmull-Rom tangents that depend on this point
+        for (size_t i : {(m_selected + n - 1) % n, (m_selected + 1) % n})
+        {
+            cps[i].tangent = 0.5f * (cps[(i + 1) % n].position - cps[(i + n - 1) % n].position);
+        }
+
+        m_dirty = true;
+        m_curve_changed = true;
+    }
+
+    void TrackEditor::release()
+    {
+        m_dragging = false;
+    }
+
+    void TrackEditor::cancel()
+    {
+        m_dragging = false;
+        m_editing = false;
+        m_dirty = false;
+        m_stage = Stage::Idle;
+        m_curve_changed = false;
+    }
+
+    bool TrackEditor::dragging() const { return m_dragging; }
+
+    bool TrackEditor::editing() const { return m_editing; }
+
+    size_t TrackEditor::selected() const { return m_selected; }
+
+    CoasterCurve const &TrackEditor::curve() const { return m_curve; }
+
+    bool TrackEditor::takeCurveChanged()
+    {
+        return std::exchange(m_curve_changed, false);
+    }
+
+    float TrackEditor::progress() const
+    {
+        switch (m_stage)
+        {
+        case Stage::Idle: return 0.0f;
+        case Stage::Rebuild: return m_staging->SlicedRebuildProgress();
+        default: return 1.0f;
+        }
+    }
+
+    TrackEditor::Staged &TrackEditor::staged()
+    {
+        return m_staged;
+    }
+
+    bool TrackEditor::update(RollerCoaster &live, float budget_ms, StagingOptions const &options)
+    {
+        if (!m_editing)
+        {
+            return false;
+        }
+        // done once the point is let go and the track has caught up
+        if (!m_dragging && !m_dirty && m_stage == Stage::Idle)
+        {
+            m_editing = false;
+            m_staging.reset();
+            return false;
+        }
+        PROFILE_SCOPE("edit rebuild");
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float, std::milli>(budget_ms));
+
+        // start on the latest edits (the staging copy keeps the motion parameters and trees of the live track)
+        if (m_stage == Stage::Idle && m_dirty)
+        {
+            m_staging->BeginSlicedRebuild(m_curve);
+            m_stage = Stage::Rebuild;
+            m_dirty = false;
+        }
+
+        // after the rebuild each frame builds one piece for the render thread, so the swap only has uploads left
+        CoasterCurve const &curve = m_staging->GetCurve();
+        switch (m_stage)
+        {
+        case Stage::Idle:
+            return false;
+        case Stage::Rebuild:
+            if (m_staging->StepSlicedRebuild(deadline))
+            {
+                m_options = options;
+                m_stage = Stage::ControlPoints;
+            }
+            return false;
+        case Stage::ControlPoints:
+            m_staged.cp_geometry = curve.controlPointFrameGeometry();
+            m_staged.cp_t_geometry = curve.controlPointGeometry();
+            m_staged.track_geometry.reset();
+            m_staged.rails.reset();
+            m_stage = m_options.curve_samples > 0 ? Stage::CurveSamples : Stage::FrameTexels;
+            return false;
+        case Stage::CurveSamples:
+            m_staged.track_geometry = curve.sampledGeometry(m_options.curve_samples);
+            m_stage = Stage::FrameTexels;
+            return false;
+        case Stage::FrameTexels:
+            m_staging->GetFrameCache().packTexels(m_staged.frame_texels);
+            m_stage = m_options.sweep_rails ? Stage::Rails : Stage::Swap;
+            return false;
+        case Stage::Rails:
+            m_staged.rails = sweepRails(m_staging->GetFrameCache(), m_options.scheduler);
+            m_stage = Stage::Swap;
+            return false;
+        case Stage::Swap:
+            break;
+        }
+
+        // the old live track becomes the next staging copy, it is rebuilt from scratch anyway
+        std::swap(live, *m_staging);
+        m_stage = Stage::Idle;
+        return true;
+    }
+}
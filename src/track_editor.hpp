@@ -0,0 +1,122 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "hermite_curve.hpp"
+#include "RollerCoaster.hpp"
+#include "rail_mesh.hpp"
+#include <glm/glm.hpp>
+#include <optional>
+#include <vector>
+
+// how close (world units) a pick ray has to pass the curve
+#define PICK_RADIUS 1.0f
+
+namespace modelling
+{
+    /**
+     * Drags control points of the live roller coaster around.
+     * Edits go into a working copy of the curve straight away (cheap to show with the GPU curve),
+     * the track itself is rebuilt on a staging roller coaster a time budget at a time, then what the render thread
+     * needs to draw it is built one piece per frame, and it is swapped in once there is only uploading left.
+     * If more edits arrive while a rebuild runs, the next rebuild picks them all up once it is done.
+     */
+    class TrackEditor
+    {
+    public:
+        // what to build for the render thread before a rebuilt track is swapped in
+        struct StagingOptions
+        {
+            size_t curve_samples = 0; // points of the CPU sampled curve, 0 when the GPU samples it
+            bool sweep_rails = false; // sweep the rail mesh (when the swept rails are drawn)
+            tasks::TaskScheduler *scheduler = nullptr; // sweeps the rails in parallel
+        };
+
+        // CPU side data for the swapped in track, only left to upload
+        struct Staged
+        {
+            givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP> cp_geometry;
+            givr::geometry::MultiLine cp_t_geometry;
+            std::optional<givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP>> track_geometry; // only with curve_samples
+            std::vector<glm::vec4> frame_texels; // see FrameCache::packTexels
+            std::optional<RailMesh> rails; // only with sweep_rails
+        };
+
+        /**
+         * pick the control point nearest to where a ray passes the track
+         * @return false if the ray does not come within PICK_RADIUS of the curve
+         */
+        bool pick(RollerCoaster const &roller_coaster, glm::vec3 origin, glm::vec3 direction);
+
+        /**
+         * move the picked control point to where the ray crosses the plane through it facing the camera
+         * the tangents of its neighbours are recomputed (Catmull-Rom, the same as for loaded tracks)
+         */
+        void drag(glm::vec3 origin, glm::vec3 direction);
+
+        // stop dragging (the rebuilds carry on until the track has caught up)
+        void release();
+
+        // drop the edit (when another track is loaded)
+        void cancel();
+
+        bool dragging() const;
+        // true from the first drag until the last rebuild is swapped in
+        bool editing() const;
+        // the picked control point
+        size_t selected() const;
+
+        /**
+         * spend up to budget_ms on rebuilding the track for the edits so far, then on staging it (one piece a frame)
+         * @param live the roller coaster being drawn, it is swapped with the staging one when everything is staged
+         * @param options what to stage, read when the staging starts
+         * @return true when live was replaced (upload what staged() holds)
+         */
+        bool update(RollerCoaster &live, float budget_ms, StagingOptions const &options);
+
+        // the data staged for the track swapped in by the last update that returned true (move out of it)
+        Staged &staged();
+
+        // the curve with every edit so far (ahead of the live track while a rebuild runs)
+        CoasterCurve const &curve() const;
+
+        // true once after each drag that moved the point (to refresh the GPU curve)
+        bool takeCurveChanged();
+
+        // the progress of the running rebuild in [0, 1]
+        float progress() const;
+
+    private:
+        // the pieces staged after the rebuild, one per frame
+        enum class Stage
+        {
+            Idle,
+            Rebuild,
+            ControlPoints,
+            CurveSamples,
+            FrameTexels,
+            Rails,
+            Swap,
+        };
+
+        CoasterCurve m_curve;
+        // rebuilt in slices, then swapped with the live roller coaster
+        std::optional<RollerCoaster> m_staging;
+        Stage m_stage = Stage::Idle;
+        StagingOptions m_options;
+        Staged m_staged;
+        size_t m_selected = 0;
+        bool m_dragging = false;
+        bool m_editing = false;
+        bool m_dirty = false; // edits that no rebuild has started on yet
+        bool m_curve_changed = false;
+
+        // the drag plane
+        glm::vec3 m_plane_point{0.0f};
+        glm::vec3 m_plane_normal{0.0f, 0.0f, 1.0f};
+    };
+}
@@ -0,0 +1,168 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "track_loader.hpp"
+#include "curve_file_io.hpp"
+#include "alloc_counter.hpp"
+#include "profiler.hpp"
+
+namespace modelling
+{
+    TrackLoader::~TrackLoader()
+    {
+        cancel();
+        reapThreads(true);
+    }
+
+    void TrackLoader::start(std::string file_path, RollerCoaster roller_coaster, size_t curve_samples)
+    {
+        cancel();
+        reapThreads(false);
+
+        std::shared_ptr<Job> job = std::make_shared<Job>();
+        std::thread thread(run, job, std::move(file_path), std::move(roller_coaster), curve_samples);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = job;
+        m_threads.emplace_back(job, std::move(thread));
+    }
+
+    void TrackLoader::cancel()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_job)
+        {
+            m_job->cancelled = true;
+        }
+    }
+
+    bool TrackLoader::busy() const
+    {
+        return m_job && !m_job->finished;
+    }
+
+    TrackLoader::Stage TrackLoader::stage() const
+    {
+        return m_job ? m_job->stage.load() : Stage::Idle;
+    }
+
+    float TrackLoader::progress() const
+    {
+        return m_job ? m_job->progress.load() : 0.0f;
+    }
+
+    const char *TrackLoader::stageName(Stage stage)
+    {
+        switch (stage)
+        {
+        case Stage::Idle: return "Idle";
+        case Stage::Parsing: return "Parsing control points";
+        case Stage::ArcLength: return "Building arc length table";
+        case Stage::Transforms: return "Building track and supports";
+        case Stage::Staging: return "Staging geometry";
+        case Stage::Done: return "Done";
+        case Stage::Failed: return "Failed";
+        case Stage::Cancelled: return "Cancelled";
+        }
+        return "";
+    }
+
+    std::unique_ptr<TrackLoader::Result> TrackLoader::takeResult()
+    {
+        reapThreads(false);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // the finished flag is set after the result is written, so the result is safe to take
+        if (!m_job || !m_job->finished || m_job->stage != Stage::Done)
+        {
+            return nullptr;
+        }
+        return std::move(m_job->result);
+    }
+
+    void TrackLoader::reapThreads(bool wait)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_threads.begin(); it != m_threads.end();)
+        {
+            if (wait || it->first->finished)
+            {
+                it->second.join();
+                it = m_threads.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void TrackLoader::run(std::shared_ptr<Job> job, std::string file_path, RollerCoaster roller_coaster, size_t curve_samples)
+    {
+        PROFILE_SCOPE("load track");
+
+        // stops the job at a stage boundary, returns true if it was cancelled
+        auto cancelled = [&job]() {
+            if (job->cancelled)
+            {
+                job->stage = Stage::Cancelled;
+                job->finished = true;
+                return true;
+            }
+            return false;
+        };
+
+        size_t start_allocations = memory::threadHeapAllocationCount();
+
+        // parse the control points
+        job->stage = Stage::Parsing;
+        std::optional<HermiteCurve> optional_curve;
+        {
+            PROFILE_SCOPE("parse control points");
+            optional_curve = readHermiteCurveFromAnyFile(file_path);
+        }
+        if (!optional_curve || optional_curve->size() == 0)
+        {
+            job->stage = Stage::Failed;
+            job->finished = true;
+            return;
+        }
+        size_t parse_allocations = memory::threadHeapAllocationCount() - start_allocations;
+        job->progress = 0.25f;
+        if (cancelled()) return;
+
+        std::unique_ptr<Result> result = std::make_unique<Result>(Result{std::move(roller_coaster), {}, {}, {}});
+        result->parse_allocations = parse_allocations;
+
+        // the arc length table and speed parameters, the control points are moved all the way into the roller coaster
+        job->stage = Stage::ArcLength;
+        result->roller_coaster.SetCurve(CoasterCurve(std::move(optional_curve->controlPoints())));
+        job->progress = 0.5f;
+        if (cancelled()) return;
+
+        // frames, track pieces, supports and trees
+        job->stage = Stage::Transforms;
+        result->roller_coaster.RebuildTrack();
+        result->roller_coaster.GenerateTrees();
+        job->progress = 0.75f;
+        if (cancelled()) return;
+
+        // build the debug geometry here so the render thread only has to upload it
+        job->stage = Stage::Staging;
+        CoasterCurve const &curve = result->roller_coaster.GetCurve();
+        result->cp_geometry = curve.controlPointFrameGeometry();
+        result->cp_t_geometry = curve.controlPointGeometry();
+        result->track_geometry = curve.sampledGeometry(curve_samples);
+        if (cancelled()) return;
+
+        result->load_allocations = memory::threadHeapAllocationCount() - start_allocations;
+
+        job->result = std::move(result);
+        job->progress = 1.0f;
+        job->stage = Stage::Done;
+        job->finished = true;
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include "hermite_curve.hpp"
+#include "RollerCoaster.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace modelling
+{
+    /**
+     * Loads a roller coaster on a background thread so the render thread never stalls.
+     * The pipeline is parse -> arc length table -> frames, track and support transforms -> geometry staging.
+     * The render thread polls takeResult() once per frame and swaps the finished roller coaster in,
+     * the GPU upload of the staged geometry happens there as well.
+     */
+    class TrackLoader
+    {
+    public:
+        enum class Stage
+        {
+            Idle,
+            Parsing,
+            ArcLength,
+            Transforms,
+            Staging,
+            Done,
+            Failed,
+            Cancelled
+        };
+
+        // everything the render thread needs to swap in a new track
+        struct Result
+        {
+            // owns the loaded curve (get it with GetCurve)
+            RollerCoaster roller_coaster;
+
+            // CPU side geometry for the debug curve, uploaded by the render thread
+            givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP> cp_geometry;
+            givr::geometry::MultiLine cp_t_geometry;
+            givr::geometry::PolyLine<givr::PrimitiveType::LINE_LOOP> track_geometry;
+
+            // heap allocations made by the loading thread while parsing (the control point buffer is one of them)
+            size_t parse_allocations = 0;
+            // heap allocations made by the loading thread for the whole load
+            size_t load_allocations = 0;
+        };
+
+        TrackLoader() = default;
+
+        /**
+         * cancels the running load and waits for every loading thread to finish
+         */
+        ~TrackLoader();
+
+        TrackLoader(const TrackLoader &) = delete;
+        TrackLoader &operator=(const TrackLoader &) = delete;
+
+        /**
+         * start loading a track, any load that is still running is cancelled
+         * @param file_path the OBJ file with the control points
+         * @param roller_coaster a roller coaster with the motion parameters to use (the curve is replaced)
+         * @param curve_samples the number of samples for the debug curve geometry
+         */
+        void start(std::string file_path, RollerCoaster roller_coaster, size_t curve_samples);
+
+        // cancel the running load (it stops at the next stage boundary)
+        void cancel();
+
+        // true while a load is running
+        bool busy() const;
+
+        // the stage of the most recent load
+        Stage stage() const;
+
+        // the progress of the most recent load in [0, 1]
+        float progress() const;
+
+        // a readable name for a stage
+        static const char *stageName(Stage stage);
+
+        /**
+         * get the finished result, this hands it over once and returns null otherwise
+         * call this from the render thread at a frame boundary
+         */
+        std::unique_ptr<Result> takeResult();
+
+    private:
+        // the state shared between the render thread and one loading thread
+        struct Job
+        {
+            std::atomic<Stage> stage{Stage::Parsing};
+            std::atomic<float> progress{0.0f};
+            std::atomic<bool> cancelled{false};
+            std::atomic<bool> finished{false};
+            std::unique_ptr<Result> result;
+        };
+
+        std::shared_ptr<Job> m_job;
+        // threads of cancelled or finished jobs that still need to be joined
+        std::vector<std::pair<std::shared_ptr<Job>, std::thread>> m_threads;
+        std::mutex m_mutex;
+
+        static void run(std::shared_ptr<Job> job, std::string file_path, RollerCoaster roller_coaster, size_t curve_samples);
+
+        // join the threads whose jobs have finished
+        void reapThreads(bool wait);
+    };
+}
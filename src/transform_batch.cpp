@@ -0,0 +1,96 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "transform_batch.hpp"
+#include "metrics.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_BATCH_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace modelling
+{
+#ifdef TRANSFORM_BATCH_SSE
+    namespace
+    {
+        inline __m128 load3(glm::vec3 const &v)
+        {
+            return _mm_setr_ps(v.x, v.y, v.z, 0.0f);
+        }
+
+        // (a.yzx * b.zxy) - (a.zxy * b.yzx), the w lane stays zero
+        inline __m128 cross3(__m128 a, __m128 b)
+        {
+            __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+
+        // divides by the length, the dot product ends up in every lane
+        inline __m128 normalize3(__m128 v)
+        {
+            __m128 sq = _mm_mul_ps(v, v);
+            __m128 sum = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+            sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+            return _mm_div_ps(v, _mm_sqrt_ps(sum));
+        }
+
+        template <typename ScaleAt>
+        void assemble(size_t count, glm::vec3 const *positions, glm::vec3 const *tangents,
+                      glm::vec3 const *normals, ScaleAt scale_at, glm::mat4 *out)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                __m128 N = normalize3(load3(normals[i]));
+                __m128 B = normalize3(cross3(N, load3(tangents[i])));
+                __m128 T = cross3(B, N);
+
+                glm::vec3 const &s = scale_at(i);
+                float *M = &out[i][0][0];
+                _mm_storeu_ps(M + 0, _mm_mul_ps(B, _mm_set1_ps(s.x)));
+                _mm_storeu_ps(M + 4, _mm_mul_ps(N, _mm_set1_ps(s.y)));
+                _mm_storeu_ps(M + 8, _mm_mul_ps(T, _mm_set1_ps(s.z)));
+                _mm_storeu_ps(M + 12, _mm_setr_ps(positions[i].x, positions[i].y, positions[i].z, 1.0f));
+            }
+        }
+    }
+#else
+    namespace
+    {
+        template <typename ScaleAt>
+        void assemble(size_t count, glm::vec3 const *positions, glm::vec3 const *tangents,
+                      glm::vec3 const *normals, ScaleAt scale_at, glm::mat4 *out)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                glm::vec3 N = glm::normalize(normals[i]);
+                glm::vec3 B = glm::normalize(glm::cross(N, tangents[i]));
+                glm::vec3 T = glm::cross(B, N);
+
+                glm::vec3 const &s = scale_at(i);
+                out[i] = glm::mat4(glm::vec4(B * s.x, 0.0f), glm::vec4(N * s.y, 0.0f),
+                                   glm::vec4(T * s.z, 0.0f), glm::vec4(positions[i], 1.0f));
+            }
+        }
+    }
+#endif
+
+    void assembleTransforms(size_t count, glm::vec3 const *positions, glm::vec3 const *tangents,
+                            glm::vec3 const *normals, glm::vec3 scale, glm::mat4 *out)
+    {
+        METRICS_ADD(TRANSFORM_BUILDS, count);
+        assemble(count, positions, tangents, normals, [&scale](size_t) -> glm::vec3 const & { return scale; }, out);
+    }
+
+    void assembleTransforms(size_t count, glm::vec3 const *positions, glm::vec3 const *tangents,
+                            glm::vec3 const *normals, glm::vec3 const *scales, glm::mat4 *out)
+    {
+        METRICS_ADD(TRANSFORM_BUILDS, count);
+        assemble(count, positions, tangents, normals, [scales](size_t i) -> glm::vec3 const & { return scales[i]; }, out);
+    }
+}
@@ -0,0 +1,34 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+
+namespace modelling
+{
+    /**
+     * Builds column major transforms with columns (B * scale.x, N * scale.y, T * scale.z, P) from arrays of frames.
+     * The normal is kept as given (normalized), B = normalize(N x T) and the tangent is re-orthogonalized as B x N,
+     * so passing the world up vector as the normal gives a level transform.
+     * Uses SSE when it is available and falls back to scalar glm otherwise.
+     * @param count the number of transforms to build
+     * @param positions the translation of each transform
+     * @param tangents the tangent (local z axis) of each transform, does not need to be normalized
+     * @param normals the normal (local y axis) of each transform, does not need to be normalized
+     * @param scale the scale applied to every transform
+     * @param out the destination, must hold count matrices
+     */
+    void assembleTransforms(size_t count, glm::vec3 const *positions, glm::vec3 const *tangents,
+                            glm::vec3 const *normals, glm::vec3 scale, glm::mat4 *out);
+
+    /**
+     * same as above but with a scale per transform
+     */
+    void assembleTransforms(size_t count, glm::vec3 const *positions, glm::vec3 const *tangents,
+                            glm::vec3 const *normals, glm::vec3 const *scales, glm::mat4 *out);
+}
@@ -0,0 +1,72 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "RollerCoaster.hpp"
+#include "arc_length_parameterize.hpp"
+#include "curve_file_io.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// the table spacing main.cpp builds its roller coaster with
+#define DELTA_S 0.34f
+// how far sAt(table(s)) may land from s (mostly the lerp between s -> U entries)
+#define ROUND_TRIP_TOLERANCE (0.25f * DELTA_S)
+#define ROUND_TRIP_SAMPLES 10000
+
+/*
+ * Builds the arc length table of each track and checks the U -> s lengths stay one per segment start (so they grow
+ * with the track, not with the longest segment), that sAt inverts the table and that both directions together take
+ * less memory than the s -> U values would as plain floats.
+ * usage: arc_length_table track files...
+ */
+int main(int argc, char **argv)
+{
+    int failures = 0;
+    for (int arg = 1; arg < argc; arg++)
+    {
+        std::optional<modelling::HermiteCurve> curve = modelling::readHermiteCurveFromAnyFile(argv[arg]);
+        if (!curve || curve->size() == 0)
+        {
+            std::fprintf(stderr, "%s: could not be read\n", argv[arg]);
+            failures++;
+            continue;
+        }
+
+        // the delta u RollerCoaster::TableDeltaU uses
+        float delta_u = (SAMPLING_FACTOR * DELTA_S) / (float(curve->size()) * curve->maxSeperation());
+        modelling::ArcLengthTable table = modelling::calculateArcLengthTable(*curve, DELTA_S, delta_u);
+
+        // at most the segment starts and the s -> U entries, whatever the spacing of the control points
+        size_t limit = table.size() + curve->size() + 1;
+        bool lengths_ok = table.lengthSamples() <= limit;
+        size_t float_bytes = (table.size() + 1) * sizeof(float);
+        bool bytes_ok = table.bytes() < float_bytes;
+
+        std::vector<float> s(ROUND_TRIP_SAMPLES);
+        std::vector<float> U(s.size());
+        std::vector<float> back(s.size());
+        for (size_t i = 0; i < s.size(); i++)
+        {
+            s[i] = table.arc_length * float(i) / float(s.size());
+        }
+        table(s.data(), U.data(), s.size());
+        table.sAt(U.data(), back.data(), U.size());
+        float worst = 0.0f;
+        for (size_t i = 0; i < s.size(); i++)
+        {
+            // s near the end can come back as a little past 0
+            float d = std::abs(back[i] - s[i]);
+            worst = std::max(worst, std::min(d, std::abs(d - table.arc_length)));
+        }
+        bool round_trip_ok = worst <= ROUND_TRIP_TOLERANCE;
+
+        std::printf("%s: %zu lengths (limit %zu), %zu values, %zu bytes (%zu as floats), worst round trip %.5f (tolerance %.3f)\n",
+                    argv[arg], table.lengthSamples(), limit, table.size(), table.bytes(), float_bytes, worst, ROUND_TRIP_TOLERANCE);
+        failures += (lengths_ok && bytes_ok && round_trip_ok) ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "alloc_counter.hpp"
+#include "task_scheduler.hpp"
+#include "track_loader.hpp"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// the parameters main.cpp builds its roller coaster with
+#define SEP_DIST 0.5f
+#define MIN_V 5.0f
+#define DEC_FRAC 0.9f
+#define DELTA_S 0.34f
+#define LOOK_AHEAD 5.0f
+#define SUPPORT_SPACING 20.0f
+#define NUM_TREES 30
+#define CURVE_SAMPLES 300
+
+// the reader's buffer is the only one, it is moved into the roller coaster and never copied
+#define EXPECTED_CONTROL_POINT_BUFFERS 1
+
+/*
+ * Loads a track through the TrackLoader (with the rebuilds on a task scheduler, like the app) and checks the number
+ * of control point buffers allocated on any thread, so a copy sneaking back into the load path fails the test.
+ * usage: loader_allocations [track file]
+ */
+int main(int argc, char **argv)
+{
+    const char *file_path = argc > 1 ? argv[1] : "models/roller_coaster_1.obj";
+
+    tasks::TaskScheduler scheduler;
+    modelling::RollerCoaster roller_coaster(SEP_DIST, MIN_V, DEC_FRAC, DELTA_S, LOOK_AHEAD, SUPPORT_SPACING, NUM_TREES);
+    roller_coaster.SetScheduler(&scheduler);
+
+    size_t before = memory::bufferAllocations<modelling::CurveControlPoint>().load();
+
+    modelling::TrackLoader loader;
+    loader.start(file_path, std::move(roller_coaster), CURVE_SAMPLES);
+    std::unique_ptr<modelling::TrackLoader::Result> result;
+    while (!result && loader.busy())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        result = loader.takeResult();
+    }
+    if (!result)
+    {
+        result = loader.takeResult();
+    }
+    if (!result)
+    {
+        std::fprintf(stderr, "loading %s failed (%s)\n", file_path, modelling::TrackLoader::stageName(loader.stage()));
+        return 1;
+    }
+
+    size_t buffers = memory::bufferAllocations<modelling::CurveControlPoint>().load() - before;
+    std::printf("%s: %zu control points, %zu control point buffers (expected %d)\n", file_path,
+                result->roller_coaster.GetCurve().size(), buffers, EXPECTED_CONTROL_POINT_BUFFERS);
+    return buffers == EXPECTED_CONTROL_POINT_BUFFERS ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+/**
+ * CPSC 587 W26 Assignment 1
+ * @name Holden Holzer
+ * @email holden.holzer@ucalgary.ca
+ */
+
+#include "RollerCoaster.hpp"
+#include "curve_file_io.hpp"
+#include "metrics.hpp"
+#include "task_scheduler.hpp"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+// the parameters main.cpp builds its roller coaster with
+#define SEP_DIST 0.5f
+#define MIN_V 5.0f
+#define DEC_FRAC 0.9f
+#define DELTA_S 0.34f
+#define LOOK_AHEAD 5.0f
+#define SUPPORT_SPACING 20.0f
+#define NUM_TREES 30
+
+// the work this thread hands to the scheduler while the rebuild runs
+#define FRAME_ITEMS 4096
+
+/*
+ * Rebuilds a track on another thread (sharing the task scheduler) while this thread counts its own work through the
+ * same scheduler, and checks the "frame" gets exactly what it added and none of the rebuild's curve evaluations,
+ * while the rebuild still gets the evaluations its tasks made on the workers.
+ * usage: metrics_scope [track file]
+ */
+int main(int argc, char **argv)
+{
+    if (!metrics::enabled())
+    {
+        std::printf("metrics are compiled out, nothing to check\n");
+        return 0;
+    }
+
+    const char *file_path = argc > 1 ? argv[1] : "models/roller_coaster_1.obj";
+    std::optional<modelling::HermiteCurve> curve = modelling::readHermiteCurveFromAnyFile(file_path);
+    if (!curve || curve->size() == 0)
+    {
+        std::fprintf(stderr, "%s: could not be read\n", file_path);
+        return 1;
+    }
+
+    tasks::TaskScheduler scheduler;
+    modelling::RollerCoaster roller_coaster(SEP_DIST, MIN_V, DEC_FRAC, DELTA_S, LOOK_AHEAD, SUPPORT_SPACING, NUM_TREES);
+    roller_coaster.SetScheduler(&scheduler);
+
+    metrics::Snapshot frame_before = metrics::threadSink().snapshot();
+
+    std::atomic<bool> rebuilt{false};
+    std::thread loader([&]() {
+        roller_coaster.UpdateCurve(modelling::CoasterCurve(std::move(curve->controlPoints())));
+        rebuilt = true;
+    });
+
+    // keep handing the scheduler frame work until the rebuild is done, so both share the workers
+    uint64_t frame_items = 0;
+    do
+    {
+        scheduler.parallel_for(0, FRAME_ITEMS, FRAME_ITEMS / 16, [](size_t begin, size_t end) {
+            METRICS_ADD(TABLE_LOOKUPS, end - begin);
+        });
+        frame_items += FRAME_ITEMS;
+    } while (!rebuilt);
+    loader.join();
+
+    metrics::Snapshot frame = metrics::threadSink().snapshot() - frame_before;
+    metrics::Snapshot rebuild = roller_coaster.LastRebuildMetrics();
+
+    bool frame_ok = frame[metrics::TABLE_LOOKUPS] == frame_items && frame[metrics::CURVE_EVALUATIONS] == 0;
+    bool rebuild_ok = rebuild[metrics::CURVE_EVALUATIONS] > 0;
+    std::printf("frame: %llu table lookups (expected %llu), %llu curve evaluations (expected 0)\n"
+                "rebuild: %llu table lookups, %llu curve evaluations\n",
+                (unsigned long long)frame[metrics::TABLE_LOOKUPS], (unsigned long long)frame_items,
+                (unsigned long long)frame[metrics::CURVE_EVALUATIONS],
+                (unsigned long long)rebuild[metrics::TABLE_LOOKUPS], (unsigned long long)rebuild[metrics::CURVE_EVALUATIONS]);
+    return (frame_ok && rebuild_ok) ? 0 : 1;
+}